@@ -0,0 +1,422 @@
+// Batch.cpp
+#include "Batch.hpp"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(BATCH_SCALAR) && defined(__AVX2__)
+#  include <immintrin.h>
+#  define BATCH_AVX2 1
+#elif !defined(BATCH_SCALAR) && defined(__SSE2__)
+#  include <emmintrin.h>
+#  define BATCH_SSE2 1
+#endif
+
+using namespace std;
+
+static_assert(BATCH_LANES == 32, "kernels assume 32 one-byte lanes");
+
+// Vector of BATCH_LANES unsigned bytes, one per game.  Masks are 0xFF in
+// lanes where a condition holds and 0 elsewhere.
+
+#if BATCH_AVX2
+
+struct V { __m256i x; };
+
+static inline V load(const uint8_t *p) {
+  return {_mm256_load_si256(reinterpret_cast<const __m256i *>(p))};
+}
+static inline void store(uint8_t *p, V a) {
+  _mm256_store_si256(reinterpret_cast<__m256i *>(p), a.x);
+}
+static inline V splat(int b) { return {_mm256_set1_epi8(static_cast<char>(b))}; }
+static inline V operator&(V a, V b) { return {_mm256_and_si256(a.x, b.x)}; }
+static inline V operator|(V a, V b) { return {_mm256_or_si256(a.x, b.x)}; }
+static inline V operator^(V a, V b) { return {_mm256_xor_si256(a.x, b.x)}; }
+static inline V andnot(V a, V b) { return {_mm256_andnot_si256(a.x, b.x)}; }
+static inline V operator+(V a, V b) { return {_mm256_add_epi8(a.x, b.x)}; }
+static inline V operator-(V a, V b) { return {_mm256_sub_epi8(a.x, b.x)}; }
+static inline V eq(V a, V b) { return {_mm256_cmpeq_epi8(a.x, b.x)}; }
+static inline V vmax(V a, V b) { return {_mm256_max_epu8(a.x, b.x)}; }
+static inline V vmin(V a, V b) { return {_mm256_min_epu8(a.x, b.x)}; }
+static inline bool any(V a) { return _mm256_movemask_epi8(a.x) != 0; }
+
+#elif BATCH_SSE2
+
+struct V { __m128i lo, hi; };
+
+static inline V load(const uint8_t *p) {
+  const __m128i *q = reinterpret_cast<const __m128i *>(p);
+  return {_mm_load_si128(q), _mm_load_si128(q + 1)};
+}
+static inline void store(uint8_t *p, V a) {
+  __m128i *q = reinterpret_cast<__m128i *>(p);
+  _mm_store_si128(q, a.lo);
+  _mm_store_si128(q + 1, a.hi);
+}
+static inline V splat(int b) {
+  __m128i x = _mm_set1_epi8(static_cast<char>(b));
+  return {x, x};
+}
+#  define BATCH_SSE2_OP(name, intrinsic)                                 \
+  static inline V name(V a, V b) {                                        \
+    return {intrinsic(a.lo, b.lo), intrinsic(a.hi, b.hi)};                \
+  }
+BATCH_SSE2_OP(operator&, _mm_and_si128)
+BATCH_SSE2_OP(operator|, _mm_or_si128)
+BATCH_SSE2_OP(operator^, _mm_xor_si128)
+BATCH_SSE2_OP(andnot, _mm_andnot_si128)
+BATCH_SSE2_OP(operator+, _mm_add_epi8)
+BATCH_SSE2_OP(operator-, _mm_sub_epi8)
+BATCH_SSE2_OP(eq, _mm_cmpeq_epi8)
+BATCH_SSE2_OP(vmax, _mm_max_epu8)
+BATCH_SSE2_OP(vmin, _mm_min_epu8)
+#  undef BATCH_SSE2_OP
+static inline bool any(V a) {
+  return _mm_movemask_epi8(_mm_or_si128(a.lo, a.hi)) != 0;
+}
+
+#else
+
+struct V { uint8_t b[BATCH_LANES]; };
+
+static inline V load(const uint8_t *p) {
+  V a;
+  memcpy(a.b, p, BATCH_LANES);
+  return a;
+}
+static inline void store(uint8_t *p, V a) { memcpy(p, a.b, BATCH_LANES); }
+static inline V splat(int b) {
+  V a;
+  memset(a.b, b, BATCH_LANES);
+  return a;
+}
+#  define BATCH_SCALAR_OP(name, expr)                                     \
+  static inline V name(V a, V b) {                                        \
+    V r;                                                                  \
+    for (int i = 0; i < BATCH_LANES; ++i) {                               \
+      uint8_t x = a.b[i], y = b.b[i];                                     \
+      r.b[i] = static_cast<uint8_t>(expr);                                \
+    }                                                                     \
+    return r;                                                             \
+  }
+BATCH_SCALAR_OP(operator&, x & y)
+BATCH_SCALAR_OP(operator|, x | y)
+BATCH_SCALAR_OP(operator^, x ^ y)
+BATCH_SCALAR_OP(andnot, ~x & y)
+BATCH_SCALAR_OP(operator+, x + y)
+BATCH_SCALAR_OP(operator-, x - y)
+BATCH_SCALAR_OP(eq, x == y ? 0xFF : 0)
+BATCH_SCALAR_OP(vmax, x > y ? x : y)
+BATCH_SCALAR_OP(vmin, x < y ? x : y)
+#  undef BATCH_SCALAR_OP
+static inline bool any(V a) {
+  for (uint8_t x : a.b) {
+    if (x) return true;
+  }
+  return false;
+}
+
+#endif
+
+const char * batch_kernels() {
+#if BATCH_AVX2
+  return "AVX2";
+#elif BATCH_SSE2
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+
+// Derived operations
+
+static inline V select(V mask, V a, V b) { return (mask & a) | andnot(mask, b); }
+static inline V ge(V a, V b) { return eq(vmax(a, b), a); }   // unsigned a >= b
+static inline V gt(V a, V b) { return andnot(eq(vmax(a, b), b), splat(0xFF)); }
+
+// Cards are encoded as (rank - NINE) * 4 + suit, so codes 0-23 sort in the
+// natural operator< order.  EMPTY marks an unused hand slot.
+
+const int EMPTY = 0xFF;
+const int HAND_SLOTS = Player::MAX_HAND_SIZE + 1;  // room for the upcard
+
+static inline uint8_t encode(const Card &c) {
+  return static_cast<uint8_t>((c.get_rank() - NINE) * 4 + c.get_suit());
+}
+
+static inline V valid(V c) { return andnot(eq(c, splat(EMPTY)), splat(0xFF)); }
+static inline V suit_of(V c) { return c & splat(3); }
+static inline V jack(V c) { return eq(c & splat(0xFC), splat((JACK - NINE) * 4)); }
+
+// Masks of the bowers and of all trump cards, for the trump suit in t
+struct Trump_info {
+  V right, left, trump;
+};
+
+static inline Trump_info trump_info(V c, V t) {
+  V suit = suit_of(c), j = jack(c);
+  Trump_info ti;
+  ti.right = j & eq(suit, t);
+  ti.left = j & eq(suit, t ^ splat(2));   // Suit_next flips bit 1
+  ti.trump = (eq(suit, t) | ti.left) & valid(c);
+  return ti;
+}
+
+// Position of c in the Card_less(trump) order: 1-24 for non-trump cards,
+// 32-55 for trump, 60 for the left bower and 61 for the right bower, and 0
+// for an empty slot.
+static inline V order_key(V c, const Trump_info &ti) {
+  V k = c + splat(1);
+  k = select(ti.trump, c + splat(32), k);
+  k = select(ti.left, splat(60), k);
+  k = select(ti.right, splat(61), k);
+  return andnot(eq(c, splat(EMPTY)), k);
+}
+
+// Suit of c as Card::get_suit(trump) reports it
+static inline V effective_suit(V c, V t, const Trump_info &ti) {
+  return select(ti.trump, t, suit_of(c));
+}
+
+// Removes and returns the card with the highest score in each lane.  Scores
+// are unique within a hand, so the first match is the only match.
+static inline V take_best(V cards[], const V scores[]) {
+  V best = scores[0];
+  for (int i = 1; i < HAND_SLOTS; ++i) best = vmax(best, scores[i]);
+  V taken = splat(0), found = splat(0);
+  for (int i = 0; i < HAND_SLOTS; ++i) {
+    V hit = andnot(found, eq(scores[i], best));
+    taken = taken | (hit & cards[i]);
+    cards[i] = select(hit, splat(EMPTY), cards[i]);
+    found = found | hit;
+  }
+  return taken;
+}
+
+// Structure-of-arrays state of all lanes
+struct Lanes {
+  alignas(32) uint8_t deck[Pack::PACK_SIZE][BATCH_LANES];
+  alignas(32) uint8_t hand[4][HAND_SLOTS][BATCH_LANES];
+  alignas(32) uint8_t score[2][BATCH_LANES];
+  alignas(32) uint8_t target[BATCH_LANES];
+  alignas(32) uint8_t shuffle[BATCH_LANES];  // 0xFF: in-shuffle every hand
+  alignas(32) uint8_t active[BATCH_LANES];   // 0xFF: game still running
+};
+
+// Fixed tables: where each dealt card goes, and the card order after
+// Pack::shuffle() (seven in-shuffles).
+struct Tables {
+  Tables() {
+    static const int BATCHES[8] = {3, 2, 3, 2, 2, 3, 2, 3};
+    int pos = 0, slots[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 8; ++i) {
+      for (int j = 0; j < BATCHES[i]; ++j, ++pos) {
+        deal_seat[pos] = i % 4;
+        deal_slot[pos] = slots[i % 4]++;
+      }
+    }
+    const int half = Pack::PACK_SIZE / 2;
+    for (int i = 0; i < Pack::PACK_SIZE; ++i) {
+      int from = i;
+      for (int k = 0; k < 7; ++k) from = (from % 2 == 0) ? from / 2 + half : from / 2;
+      shuffle_from[i] = from;
+    }
+  }
+
+  int deal_seat[20];   // seat relative to the left of the dealer
+  int deal_slot[20];
+  int shuffle_from[Pack::PACK_SIZE];
+};
+
+static const Tables TABLES;
+
+// In-shuffles the decks of shuffling lanes, then deals every lane.
+static void shuffle_and_deal(Lanes &L, int dealer) {
+  alignas(32) uint8_t old[Pack::PACK_SIZE][BATCH_LANES];
+  memcpy(old, L.deck, sizeof old);
+  V shuffling = load(L.shuffle);
+  for (int i = 0; i < Pack::PACK_SIZE; ++i) {
+    V moved = load(old[TABLES.shuffle_from[i]]);
+    store(L.deck[i], select(shuffling, moved, load(old[i])));
+  }
+  for (int pos = 0; pos < 20; ++pos) {
+    int seat = (dealer + 1 + TABLES.deal_seat[pos]) % 4;
+    memcpy(L.hand[seat][TABLES.deal_slot[pos]], L.deck[pos], BATCH_LANES);
+  }
+  for (auto &seat_hand : L.hand) {
+    memset(seat_hand[HAND_SLOTS - 1], EMPTY, BATCH_LANES);
+  }
+}
+
+// Number of face-or-ace cards that are trump in suit s
+static inline V count_good(const uint8_t hand[][BATCH_LANES], V s) {
+  V count = splat(0);
+  for (int i = 0; i < HAND_SLOTS; ++i) {
+    V c = load(hand[i]);
+    V good = trump_info(c, s).trump & ge(c, splat((JACK - NINE) * 4));
+    count = count - good;  // subtracting 0xFF adds one
+  }
+  return count;
+}
+
+// Simple::make_trump for all four seats and both rounds, then the dealer's
+// pickup in lanes where trump was ordered up in round 1.
+static void make_trump(Lanes &L, int dealer, V &maker, V &trump) {
+  V up = load(L.deck[20]);
+  V up_suit = suit_of(up);
+  V ordered = splat(0), round1 = splat(0);
+  for (int round = 1; round <= 2; ++round) {
+    V s = (round == 1) ? up_suit : (up_suit ^ splat(2));
+    for (int i = 1; i <= 4; ++i) {
+      int seat = (dealer + i) % 4;
+      V want = ge(count_good(L.hand[seat], s), splat(3 - round));
+      if (round == 2 && seat == dealer) want = splat(0xFF);
+      want = andnot(ordered, want);
+      maker = select(want, splat(seat), maker);
+      trump = select(want, s, trump);
+      ordered = ordered | want;
+      if (round == 1) round1 = round1 | want;
+    }
+  }
+
+  if (!any(round1 & load(L.active))) return;
+  // Simple::add_and_discard: pick up, then discard the lowest card
+  V cards[HAND_SLOTS], scores[HAND_SLOTS];
+  for (int i = 0; i < HAND_SLOTS; ++i) {
+    cards[i] = load(L.hand[dealer][i]);
+  }
+  cards[HAND_SLOTS - 1] = select(round1, up, cards[HAND_SLOTS - 1]);
+  for (int i = 0; i < HAND_SLOTS; ++i) {
+    V key = order_key(cards[i], trump_info(cards[i], trump));
+    // Lowest key wins: invert so take_best's maximum is the minimum
+    scores[i] = select(valid(cards[i]), splat(64) - key, splat(0));
+  }
+  V keep[HAND_SLOTS];
+  for (int i = 0; i < HAND_SLOTS; ++i) keep[i] = cards[i];
+  take_best(cards, scores);
+  for (int i = 0; i < HAND_SLOTS; ++i) {
+    store(L.hand[dealer][i], select(round1, cards[i], keep[i]));
+  }
+}
+
+// Plays one trick in every lane.  Returns the winning seat per lane.
+static V play_trick(Lanes &L, V leader, V trump, V tricks[2]) {
+  V led_suit = splat(0), best = splat(0), winner = leader;
+  for (int step = 0; step < 4; ++step) {
+    V seat = (leader + splat(step)) & splat(3);
+    V seat_is[4];
+    for (int q = 0; q < 4; ++q) seat_is[q] = eq(seat, splat(q));
+
+    // Gather the hand of the seat playing in each lane
+    V cards[HAND_SLOTS], scores[HAND_SLOTS];
+    for (int i = 0; i < HAND_SLOTS; ++i) {
+      cards[i] = load(L.hand[0][i]);
+      for (int q = 1; q < 4; ++q) {
+        cards[i] = select(seat_is[q], load(L.hand[q][i]), cards[i]);
+      }
+      Trump_info ti = trump_info(cards[i], trump);
+      V key = order_key(cards[i], ti);
+      if (step == 0) {
+        // Simple::lead_card: highest non-trump, else highest trump
+        scores[i] = key + andnot(ti.trump, valid(cards[i]) & splat(64));
+      } else {
+        // Simple::play_card: highest card following suit, else lowest card
+        V follows = eq(effective_suit(cards[i], trump, ti), led_suit) &
+                    valid(cards[i]);
+        scores[i] = select(follows, key + splat(128),
+                           select(valid(cards[i]), splat(64) - key, splat(0)));
+      }
+    }
+    V card = take_best(cards, scores);
+
+    // Scatter the hands back
+    for (int q = 0; q < 4; ++q) {
+      for (int i = 0; i < HAND_SLOTS; ++i) {
+        store(L.hand[q][i], select(seat_is[q], cards[i], load(L.hand[q][i])));
+      }
+    }
+
+    // Card_less(a, b, led_card, trump) as a key: trump over led suit over
+    // the rest
+    Trump_info ti = trump_info(card, trump);
+    V suit = effective_suit(card, trump, ti);
+    if (step == 0) led_suit = suit;
+    V strength = order_key(card, ti) +
+                 select(ti.trump, splat(64),
+                        eq(suit, led_suit) & splat(32));
+    V better = (step == 0) ? splat(0xFF) : gt(strength, best);
+    best = select(better, strength, best);
+    winner = select(better, seat, winner);
+  }
+  V team1 = eq(winner & splat(1), splat(1));
+  tricks[1] = tricks[1] - team1;
+  tricks[0] = tricks[0] - andnot(team1, splat(0xFF));
+  return winner;
+}
+
+// Scores one hand and retires lanes whose game is over.
+static void score_hand(Lanes &L, V maker, const V tricks[2], int hands,
+                       Batch_result results[]) {
+  V active = load(L.active);
+  V makers1 = eq(maker & splat(1), splat(1));
+  V taken = select(makers1, tricks[1], tricks[0]);
+  V march = eq(taken, splat(5));
+  V euchred = eq(vmin(taken, splat(2)), taken);
+  V maker_points = select(march, splat(2), andnot(euchred, splat(1)));
+  V defender_points = euchred & splat(2);
+  V points1 = select(makers1, maker_points, defender_points);
+  V points0 = select(makers1, defender_points, maker_points);
+  V score0 = load(L.score[0]) + (points0 & active);
+  V score1 = load(L.score[1]) + (points1 & active);
+  store(L.score[0], score0);
+  store(L.score[1], score1);
+
+  V target = load(L.target);
+  V won0 = ge(score0, target);
+  V done = (won0 | ge(score1, target)) & active;
+  if (!any(done)) return;
+
+  alignas(32) uint8_t done_lanes[BATCH_LANES], won0_lanes[BATCH_LANES];
+  store(done_lanes, done);
+  store(won0_lanes, won0);
+  for (int i = 0; i < BATCH_LANES; ++i) {
+    if (!done_lanes[i]) continue;
+    results[i].winner = won0_lanes[i] ? 0 : 1;
+    results[i].score[0] = L.score[0][i];
+    results[i].score[1] = L.score[1][i];
+    results[i].hands = hands;
+  }
+  store(L.active, andnot(done, active));
+}
+
+void play_batch(const Batch_game games[], int n, Batch_result results[]) {
+  assert(1 <= n && n <= BATCH_LANES);
+  Lanes L;
+  memset(&L, 0, sizeof L);
+  Batch_result lane_results[BATCH_LANES];
+  for (int i = 0; i < n; ++i) {
+    assert(1 <= games[i].config.points_to_win &&
+           games[i].config.points_to_win <= 100);
+    const auto &cards = games[i].pack.get_cards();
+    for (int k = 0; k < Pack::PACK_SIZE; ++k) L.deck[k][i] = encode(cards[k]);
+    L.target[i] = static_cast<uint8_t>(games[i].config.points_to_win);
+    L.shuffle[i] = games[i].config.shuffle ? 0xFF : 0;
+    L.active[i] = 0xFF;
+  }
+
+  for (int hand = 0; any(load(L.active)); ++hand) {
+    int dealer = hand % 4;  // every game starts together, so dealers agree
+    shuffle_and_deal(L, dealer);
+
+    V maker = splat(0), trump = splat(0);
+    make_trump(L, dealer, maker, trump);
+
+    V tricks[2] = {splat(0), splat(0)};
+    V leader = splat((dealer + 1) % 4);
+    for (int t = 0; t < 5; ++t) leader = play_trick(L, leader, trump, tricks);
+
+    score_hand(L, maker, tricks, hand + 1, lane_results);
+  }
+  for (int i = 0; i < n; ++i) results[i] = lane_results[i];
+}
@@ -0,0 +1,43 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+/* Batch.hpp
+ *
+ * Lockstep engine that plays up to BATCH_LANES games of four Simple players
+ * at once.  Each game is one lane of a structure-of-arrays layout (hands,
+ * trump, led card and trick winner are arrays indexed by lane), and every
+ * decision is made for all lanes together with AVX2 or SSE2 byte kernels,
+ * or a portable scalar loop when neither is available.
+ *
+ * Results are identical to playing each game with play_game() and four
+ * Player_factory(name, "Simple") players; fuzz.exe checks this.
+ */
+
+#include "Game.hpp"
+#include "Pack.hpp"
+
+const int BATCH_LANES = 32;
+
+// One game to play: the pack it starts from and its rules
+struct Batch_game {
+  Pack pack;
+  Game_config config;
+};
+
+// Final outcome of one game
+struct Batch_result {
+  int winner = 0;          // team that won
+  int score[2] = {0, 0};
+  int hands = 0;           // hands played
+};
+
+//REQUIRES 1 <= n <= BATCH_LANES and every game's points_to_win is 1-100
+//MODIFIES results
+//EFFECTS Plays games[0..n) to completion and stores their outcomes in
+//  results[0..n)
+void play_batch(const Batch_game games[], int n, Batch_result results[]);
+
+//EFFECTS Returns the name of the kernels play_batch was compiled with:
+//  "AVX2", "SSE2" or "scalar"
+const char * batch_kernels();
+
+#endif // BATCH_HPP
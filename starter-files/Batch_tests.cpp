@@ -0,0 +1,59 @@
+// Batch Tests
+#include "Batch.hpp"
+#include "Rng.hpp"
+#include "unit_test_framework.hpp"
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Plays g with play_game() and four Simple players
+static Batch_result play_one(const Batch_game &g) {
+    Player *players[4];
+    for (int i = 0; i < 4; ++i) players[i] = Player_factory("Simple", "Simple");
+    Game_state state{g.pack};
+    Game_observer quiet;
+    Batch_result r;
+    r.winner = play_game(state, players, g.config, quiet);
+    r.score[0] = state.score[0];
+    r.score[1] = state.score[1];
+    r.hands = state.hand;
+    for (Player *p : players) delete p;
+    return r;
+}
+
+static void assert_same(const Batch_result &a, const Batch_result &b) {
+    ASSERT_EQUAL(a.winner, b.winner);
+    ASSERT_EQUAL(a.score[0], b.score[0]);
+    ASSERT_EQUAL(a.score[1], b.score[1]);
+    ASSERT_EQUAL(a.hands, b.hands);
+}
+
+TEST(test_batch_one_lane_matches_play_game) {
+    Batch_game g;
+    g.config.points_to_win = 1;
+    Batch_result r;
+    play_batch(&g, 1, &r);
+    assert_same(r, play_one(g));
+}
+
+TEST(test_batch_full_lanes_finish_at_different_hands) {
+    Batch_game games[BATCH_LANES];
+    for (int i = 0; i < BATCH_LANES; ++i) {
+        Rng rng(i);
+        games[i].pack.shuffle(rng);
+        games[i].config.shuffle = i % 2 == 1;
+        games[i].config.points_to_win = 1 + i % 10;
+    }
+    Batch_result results[BATCH_LANES];
+    play_batch(games, BATCH_LANES, results);
+    for (int i = 0; i < BATCH_LANES; ++i) assert_same(results[i], play_one(games[i]));
+}
+
+TEST(test_batch_kernels_named) {
+    string k = batch_kernels();
+    ASSERT_TRUE(k == "AVX2" || k == "SSE2" || k == "scalar");
+}
+
+TEST_MAIN()
@@ -66,40 +66,7 @@ std::istream & operator>>(std::istream &is, Suit &suit) {
   return is;
 }
 
-// Card implementation
-Card::Card() : rank(TWO), suit(SPADES) {}
-
-Card::Card(Rank rank_in, Suit suit_in)
-  : rank(rank_in), suit(suit_in) {}
-
-Rank Card::get_rank() const { return rank; }
-Suit Card::get_suit() const { return suit; }
-
-// Left bower counts as trump suit.
-Suit Card::get_suit(Suit trump) const {
-  if (is_left_bower(trump)) {
-    return trump;
-  }
-  return suit;
-}
-
-bool Card::is_face_or_ace() const {
-  return rank == JACK || rank == QUEEN || rank == KING || rank == ACE;
-}
-
-bool Card::is_right_bower(Suit trump) const {
-  return rank == JACK && suit == trump;
-}
-
-bool Card::is_left_bower(Suit trump) const {
-  return rank == JACK && suit == Suit_next(trump);
-}
-
-bool Card::is_trump(Suit trump) const {
-  return get_suit(trump) == trump;
-}
-
-// Stream ops & relops 
+// Stream ops
 ostream &operator<<(ostream &os, const Card &card) {
   os << card.get_rank() << " of " << card.get_suit();
   return os;
@@ -119,90 +86,50 @@ istream &operator>>(istream &is, Card &card) {
   return is;
 }
 
-// Natural order (no trump/led): rank, then suit tie-break.
-bool operator<(const Card &lhs, const Card &rhs) {
-  if (lhs.get_rank() != rhs.get_rank()) {
-    return static_cast<int>(lhs.get_rank()) <
-           static_cast<int>(rhs.get_rank());
-  }
-  return static_cast<int>(lhs.get_suit()) <
-         static_cast<int>(rhs.get_suit());
-}
-
-bool operator>(const Card &l, const Card &r)  { return r < l; }
-bool operator<=(const Card &l, const Card &r) { return !(r < l); }
-bool operator>=(const Card &l, const Card &r) { return !(l < r); }
-
-bool operator==(const Card &l, const Card &r) {
-  return l.get_rank() == r.get_rank() && l.get_suit() == r.get_suit();
-}
-bool operator!=(const Card &l, const Card &r) { return !(l == r); }
-
-// Helpers
-
-// Same-color mapping for left bower: H <-> D, C <-> S
-Suit Suit_next(Suit s) {
-  if (s == HEARTS)   return DIAMONDS;
-  if (s == DIAMONDS) return HEARTS;
-  if (s == CLUBS)    return SPADES;
-  if (s == SPADES)   return CLUBS;
-  return SPADES;  // never reached
-}
-
-// Factorized bower comparison to avoid duplication in Card_less.
-static int compare_bowers(const Card &a, const Card &b, Suit trump) {
-  // +1 if a > b due to bower, -1 if a < b, 0 if neither determines
-  if (a.is_right_bower(trump)) return b.is_right_bower(trump) ? 0 : +1;
-  if (b.is_right_bower(trump)) return -1;
-  if (a.is_left_bower(trump))  return b.is_left_bower(trump)  ? 0 : +1;
-  if (b.is_left_bower(trump))  return -1;
-  return 0;
-}
-
-// Contextual comparisons
-bool Card_less(const Card &a, const Card &b, Suit trump) {
-  if (int cmp = compare_bowers(a, b, trump)) return cmp < 0;
-
-  const bool a_trump = a.is_trump(trump);
-  const bool b_trump = b.is_trump(trump);
-
-  // Any trump beats any non-trump.
-  if (a_trump != b_trump) return !a_trump && b_trump;
-
-  // Both trump or both non-trump: rank, then suit tie-break.
-  int ra = static_cast<int>(a.get_rank());
-  int rb = static_cast<int>(b.get_rank());
-  if (ra != rb) return ra < rb;
-  return a.get_suit() < b.get_suit();
-}
+// Compile-time checks of the card algebra
 
-bool Card_less(const Card &a, 
-               const Card &b,
-               const Card &led_card, 
-               Suit trump) {
-  const Suit led_suit = led_card.get_suit(trump);
+static_assert(sizeof(Card) == 1, "Card packs into one byte");
+static_assert(Suit_next(SPADES) == CLUBS && Suit_next(CLUBS) == SPADES &&
+              Suit_next(HEARTS) == DIAMONDS && Suit_next(DIAMONDS) == HEARTS,
+              "next suit has the same color");
 
-  if (int cmp = compare_bowers(a, b, trump)) return cmp < 0;
-
-  const bool a_trump = a.is_trump(trump);
-  const bool b_trump = b.is_trump(trump);
-
-  if (a_trump != b_trump) return !a_trump && b_trump;
-
-  if (a_trump && b_trump) {
-    int ra = static_cast<int>(a.get_rank());
-    int rb = static_cast<int>(b.get_rank());
-    if (ra != rb) return ra < rb;
-    return a.get_suit() < b.get_suit();
+// For every trump: right bower > left bower > A > K > Q > 10 > 9 of trump >
+// every non-trump euchre card, and the left bower is trump of the trump suit.
+static constexpr bool trump_order_holds(Suit trump) {
+  const Card order[] = {
+    Card(JACK, trump), Card(JACK, Suit_next(trump)), Card(ACE, trump),
+    Card(KING, trump), Card(QUEEN, trump), Card(TEN, trump), Card(NINE, trump),
+  };
+  for (int i = 1; i < 7; ++i) {
+    if (!Card_less(order[i], order[i - 1], trump)) return false;
+    if (Card_less(order[i - 1], order[i], trump)) return false;
   }
-
-  // Neither trump: following led suit beats not following.
-  const bool a_follows = (a.get_suit(trump) == led_suit);
-  const bool b_follows = (b.get_suit(trump) == led_suit);
-  if (a_follows != b_follows) return !a_follows && b_follows;
-
-  int ra = static_cast<int>(a.get_rank());
-  int rb = static_cast<int>(b.get_rank());
-  if (ra != rb) return ra < rb;
-  return a.get_suit() < b.get_suit();
-}
+  for (const Card &c : order) {
+    if (!c.is_trump(trump) || c.get_suit(trump) != trump) return false;
+  }
+  for (int r = NINE; r <= ACE; ++r) {
+    for (int s = SPADES; s <= DIAMONDS; ++s) {
+      Card c(static_cast<Rank>(r), static_cast<Suit>(s));
+      if (c.is_trump(trump)) continue;
+      if (!Card_less(c, order[6], trump)) return false;
+    }
+  }
+  return true;
+}
+
+static_assert(trump_order_holds(SPADES) && trump_order_holds(HEARTS) &&
+              trump_order_holds(CLUBS) && trump_order_holds(DIAMONDS),
+              "trump order");
+static_assert(Card_less(Card(ACE, HEARTS), Card(NINE, CLUBS), Card(NINE, CLUBS),
+                        SPADES), "led suit beats off suit");
+static_assert(Card_less(Card(KING, CLUBS), Card(ACE, HEARTS), Card(JACK, CLUBS),
+                        SPADES), "a led left bower leads trump, not clubs");
+static_assert(Card(KING, DIAMONDS) < Card(ACE, SPADES) &&
+              Card(ACE, SPADES) < Card(ACE, HEARTS), "natural order");
+static_assert(legal_plays(card_bit(Card(JACK, CLUBS)) | card_bit(Card(ACE, CLUBS)),
+                          Card(NINE, SPADES), SPADES) ==
+              card_bit(Card(JACK, CLUBS)), "the left bower must follow trump");
+static_assert(legal_plays(card_bit(Card(JACK, CLUBS)) | card_bit(Card(ACE, HEARTS)),
+                          Card(NINE, CLUBS), SPADES) ==
+              (card_bit(Card(JACK, CLUBS)) | card_bit(Card(ACE, HEARTS))),
+              "the left bower does not follow its printed suit");
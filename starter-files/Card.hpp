@@ -9,6 +9,7 @@
  * 2014-12-21
  */
 
+#include <cstdint>
 #include <iostream>
 
 // Represent a Card's Rank.
@@ -77,37 +78,39 @@ class Card {
 public:
 
   //EFFECTS Initializes Card to the Two of Spades
-  Card();
+  constexpr Card() noexcept;
 
   //EFFECTS Initializes Card to specified rank and suit
-  Card(Rank rank_in, Suit suit_in);
+  constexpr Card(Rank rank_in, Suit suit_in) noexcept;
 
   //EFFECTS Returns the rank
-  Rank get_rank() const;
+  constexpr Rank get_rank() const noexcept;
 
   //EFFECTS Returns the suit.  Does not consider trump.
-  Suit get_suit() const;
+  constexpr Suit get_suit() const noexcept;
 
   //EFFECTS Returns the suit
   //HINT: the left bower is the trump suit!
-  Suit get_suit(Suit trump) const;
+  constexpr Suit get_suit(Suit trump) const noexcept;
 
   //EFFECTS Returns true if card is a face card (Jack, Queen, King or Ace)
-  bool is_face_or_ace() const;
+  constexpr bool is_face_or_ace() const noexcept;
 
   //EFFECTS Returns true if card is the Jack of the trump suit
-  bool is_right_bower(Suit trump) const;
+  constexpr bool is_right_bower(Suit trump) const noexcept;
 
   //EFFECTS Returns true if card is the Jack of the next suit
-  bool is_left_bower(Suit trump) const;
+  constexpr bool is_left_bower(Suit trump) const noexcept;
 
   //EFFECTS Returns true if the card is a trump card.  All cards of the trump
   // suit are trump cards.  The left bower is also a trump card.
-  bool is_trump(Suit trump) const;
+  constexpr bool is_trump(Suit trump) const noexcept;
 
 private:
-  Rank rank;
-  Suit suit;
+  // Rank and suit packed into one byte as rank * 4 + suit, so that the
+  // natural card order is the order of the codes and a whole Pack fits in
+  // one cache line.
+  std::uint8_t code;
 
   // This "friend declaration" allows the implementation of operator>>
   // to access private member variables of the Card class.
@@ -119,42 +122,162 @@ std::ostream & operator<<(std::ostream &os, const Card &card);
 
 //EFFECTS Reads a Card from a stream in the format "Two of Spades"
 //NOTE The Card class declares this operator>> "friend" function,
-//     which means it is allowed to access card.rank and card.suit.
+//     which means it is allowed to access the card's private members.
 std::istream & operator>>(std::istream &is, Card &card);
 
 //EFFECTS Returns true if lhs is lower value than rhs.
 //  Does not consider trump.
-bool operator<(const Card &lhs, const Card &rhs);
+constexpr bool operator<(const Card &lhs, const Card &rhs) noexcept;
 
 //EFFECTS Returns true if lhs is lower value than rhs or the same card as rhs.
 //  Does not consider trump.
-bool operator<=(const Card &lhs, const Card &rhs);
+constexpr bool operator<=(const Card &lhs, const Card &rhs) noexcept;
 
 //EFFECTS Returns true if lhs is higher value than rhs.
 //  Does not consider trump.
-bool operator>(const Card &lhs, const Card &rhs);
+constexpr bool operator>(const Card &lhs, const Card &rhs) noexcept;
 
 //EFFECTS Returns true if lhs is higher value than rhs or the same card as rhs.
 //  Does not consider trump.
-bool operator>=(const Card &lhs, const Card &rhs);
+constexpr bool operator>=(const Card &lhs, const Card &rhs) noexcept;
 
 //EFFECTS Returns true if lhs is same card as rhs.
 //  Does not consider trump.
-bool operator==(const Card &lhs, const Card &rhs);
+constexpr bool operator==(const Card &lhs, const Card &rhs) noexcept;
 
 //EFFECTS Returns true if lhs is not the same card as rhs.
 //  Does not consider trump.
-bool operator!=(const Card &lhs, const Card &rhs);
+constexpr bool operator!=(const Card &lhs, const Card &rhs) noexcept;
 
 //EFFECTS returns the next suit, which is the suit of the same color
-Suit Suit_next(Suit suit);
+constexpr Suit Suit_next(Suit suit) noexcept;
 
 //EFFECTS Returns true if a is lower value than b.  Uses trump to determine
 // order, as described in the spec.
-bool Card_less(const Card &a, const Card &b, Suit trump);
+constexpr bool Card_less(const Card &a, const Card &b, Suit trump) noexcept;
 
 //EFFECTS Returns true if a is lower value than b.  Uses both the trump suit
 //  and the suit led to determine order, as described in the spec.
-bool Card_less(const Card &a, const Card &b, const Card &led_card, Suit trump);
+constexpr bool Card_less(const Card &a, const Card &b, const Card &led_card,
+                         Suit trump) noexcept;
+
+// A set of cards as a bitmask: bit rank * 4 + suit is set for each card in
+// the set.  Membership, union and the legal plays of a hand are single
+// integer operations.
+using Card_set = std::uint64_t;
+
+//EFFECTS Returns the set holding only c
+constexpr Card_set card_bit(const Card &c) noexcept;
+
+//EFFECTS Returns the set of all cards whose suit is s when trump is trump:
+//  the left bower belongs to trump and not to its printed suit
+constexpr Card_set suit_cards(Suit s, Suit trump) noexcept;
+
+//EFFECTS Returns the cards of hand that may follow led_card: those of the
+//  led suit, or all of hand if none is
+constexpr Card_set legal_plays(Card_set hand, const Card &led_card,
+                               Suit trump) noexcept;
+
+// Card algebra.  Everything below is constexpr and defined in this header so
+// that it inlines and folds in the hot loops; Card.cpp checks the trump order
+// at compile time.
+
+constexpr Card::Card() noexcept : code(TWO * 4 + SPADES) {}
+
+constexpr Card::Card(Rank rank_in, Suit suit_in) noexcept
+  : code(static_cast<std::uint8_t>(rank_in * 4 + suit_in)) {}
+
+constexpr Rank Card::get_rank() const noexcept {
+  return static_cast<Rank>(code >> 2);
+}
+
+constexpr Suit Card::get_suit() const noexcept {
+  return static_cast<Suit>(code & 3);
+}
+
+// Left bower counts as trump suit.
+constexpr Suit Card::get_suit(Suit trump) const noexcept {
+  return is_left_bower(trump) ? trump : get_suit();
+}
+
+constexpr bool Card::is_face_or_ace() const noexcept {
+  return code >= JACK * 4;
+}
+
+constexpr bool Card::is_right_bower(Suit trump) const noexcept {
+  return code == JACK * 4 + trump;
+}
+
+constexpr bool Card::is_left_bower(Suit trump) const noexcept {
+  return code == JACK * 4 + Suit_next(trump);
+}
+
+constexpr bool Card::is_trump(Suit trump) const noexcept {
+  return get_suit(trump) == trump;
+}
+
+// Natural order (no trump/led): rank, then suit tie-break, which is the
+// order of the packed codes.
+constexpr bool operator<(const Card &lhs, const Card &rhs) noexcept {
+  return lhs.get_rank() * 4 + lhs.get_suit() <
+         rhs.get_rank() * 4 + rhs.get_suit();
+}
+
+constexpr bool operator>(const Card &l, const Card &r) noexcept { return r < l; }
+constexpr bool operator<=(const Card &l, const Card &r) noexcept { return !(r < l); }
+constexpr bool operator>=(const Card &l, const Card &r) noexcept { return !(l < r); }
+
+constexpr bool operator==(const Card &l, const Card &r) noexcept {
+  return !(l < r) && !(r < l);
+}
+
+constexpr bool operator!=(const Card &l, const Card &r) noexcept {
+  return !(l == r);
+}
+
+// Same-color mapping for left bower: H <-> D, C <-> S
+constexpr Suit Suit_next(Suit s) noexcept {
+  return static_cast<Suit>(s ^ 2);
+}
+
+// Position of c in the contextual order: right bower, left bower, the other
+// trumps, then cards of led_suit (-1: no led card), then the rest, with the
+// natural order within each group.
+constexpr int Card_order(const Card &c, Suit trump, int led_suit) noexcept {
+  const int natural = c.get_rank() * 4 + c.get_suit();
+  if (c.is_right_bower(trump)) return 301;
+  if (c.is_left_bower(trump)) return 300;
+  if (c.get_suit() == trump) return 200 + natural;
+  if (c.get_suit() == led_suit) return 100 + natural;
+  return natural;
+}
+
+constexpr bool Card_less(const Card &a, const Card &b, Suit trump) noexcept {
+  return Card_order(a, trump, -1) < Card_order(b, trump, -1);
+}
+
+constexpr bool Card_less(const Card &a, const Card &b, const Card &led_card,
+                         Suit trump) noexcept {
+  const int led_suit = led_card.get_suit(trump);
+  return Card_order(a, trump, led_suit) < Card_order(b, trump, led_suit);
+}
+
+constexpr Card_set card_bit(const Card &c) noexcept {
+  return Card_set(1) << (c.get_rank() * 4 + c.get_suit());
+}
+
+constexpr Card_set suit_cards(Suit s, Suit trump) noexcept {
+  // Bit suit of every nibble: all thirteen ranks of that suit
+  const Card_set printed = Card_set(0x1111111111111) << s;
+  if (s == trump) return printed | card_bit(Card(JACK, Suit_next(trump)));
+  if (s == Suit_next(trump)) return printed & ~card_bit(Card(JACK, s));
+  return printed;
+}
+
+constexpr Card_set legal_plays(Card_set hand, const Card &led_card,
+                               Suit trump) noexcept {
+  const Card_set follow = hand & suit_cards(led_card.get_suit(trump), trump);
+  return follow ? follow : hand;
+}
 
 #endif // CARD_HPP
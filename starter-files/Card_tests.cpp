@@ -132,4 +132,73 @@ TEST(test_card_wit_led) {
     ASSERT_TRUE(Card_less(follower, follower_hi, led_card, trump));
 }
 
+TEST(test_card_packed_round_trip) {
+    ASSERT_EQUAL(sizeof(Card), 1u);
+    for (int r = TWO; r <= ACE; ++r) {
+        for (int s = SPADES; s <= DIAMONDS; ++s) {
+            Card c(static_cast<Rank>(r), static_cast<Suit>(s));
+            ASSERT_EQUAL(c.get_rank(), static_cast<Rank>(r));
+            ASSERT_EQUAL(c.get_suit(), static_cast<Suit>(s));
+            ostringstream os;
+            os << c;
+            istringstream is(os.str());
+            Card back;
+            is >> back;
+            ASSERT_EQUAL(back, c);
+        }
+    }
+    ASSERT_TRUE(Card(ACE, SPADES) < Card(ACE, HEARTS));
+    ASSERT_TRUE(Card(KING, DIAMONDS) < Card(ACE, SPADES));
+}
+
+TEST(test_legal_plays_follow_effective_suit) {
+    Card_set hand = card_bit(Card(JACK, DIAMONDS)) | card_bit(Card(ACE, HEARTS)) |
+                    card_bit(Card(NINE, CLUBS));
+    // The left bower follows trump, not diamonds
+    ASSERT_EQUAL(legal_plays(hand, Card(KING, HEARTS), HEARTS),
+                 card_bit(Card(JACK, DIAMONDS)) | card_bit(Card(ACE, HEARTS)));
+    ASSERT_EQUAL(legal_plays(hand, Card(KING, DIAMONDS), HEARTS), hand);
+    ASSERT_EQUAL(legal_plays(hand, Card(TEN, CLUBS), HEARTS),
+                 card_bit(Card(NINE, CLUBS)));
+}
+
+// BENCHMARKS --- run with ./Card_tests.exe --bench
+
+// Cards of the euchre pack in a scrambled order, so every iteration asks
+// about different cards
+static void scrambled_cards(Card cards[], int n) {
+    unsigned x = 1;
+    for (int i = 0; i < n; ++i) {
+        x = x * 1103515245 + 12345;
+        cards[i] = Card(static_cast<Rank>(NINE + (x >> 16) % 6),
+                        static_cast<Suit>((x >> 24) % 4));
+    }
+}
+
+BENCH(bench_card_less_with_led) {
+    Card cards[256];
+    scrambled_cards(cards, 256);
+    for (long i = 0; i < bench.iterations; ++i) {
+        const Card &a = cards[i & 255], &b = cards[(i + 85) & 255];
+        const Card &led = cards[(i + 170) & 255];
+        unit_test_framework::do_not_optimize(
+            Card_less(a, b, led, static_cast<Suit>(i & 3)));
+    }
+}
+
+BENCH(bench_legal_plays) {
+    Card cards[256];
+    scrambled_cards(cards, 256);
+    Card_set hands[256];
+    for (int i = 0; i < 256; ++i) {
+        hands[i] = 0;
+        for (int j = 0; j < 5; ++j) hands[i] |= card_bit(cards[(i + j * 51) & 255]);
+    }
+    for (long i = 0; i < bench.iterations; ++i) {
+        unit_test_framework::do_not_optimize(
+            legal_plays(hands[i & 255], cards[(i + 128) & 255],
+                        static_cast<Suit>(i & 3)));
+    }
+}
+
 TEST_MAIN()
@@ -0,0 +1,211 @@
+// Deck_corpus.cpp
+#include "Deck_corpus.hpp"
+#include "Rng.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+static const uint64_t CORPUS_MAGIC = 0x31534b4345445545ULL; // "EUDECKS1"
+static const size_t HEADER_BYTES = 2 * sizeof(uint64_t);
+static const size_t RECORD_BYTES = 10;
+static const int LOW_BITS = 29;
+static const int N = Pack::PACK_SIZE;
+
+// Cards are counted in the order of Pack(): suit by suit, Nine to Ace.  A
+// Card is one byte, which decoding moves about as it is.
+static_assert(sizeof(Card) == 1 && std::is_trivially_copyable<Card>::value,
+              "Card must be a single byte");
+
+static int card_index(const Card &c) {
+  return c.get_suit() * 6 + (c.get_rank() - NINE);
+}
+
+// The rank is sum of digit[i] * (23 - i)!, digit[i] being how many cards
+// not yet placed come before deck[i].  Horner's rule over the radices
+// 24, 23, ... builds it from the front; the first twelve digits make up
+// rank / 12! and the rest rank % 12!.
+Deck_code encode_deck(const Deck &deck) {
+  uint32_t unplaced = (1u << N) - 1;
+  Deck_code code;
+  for (int i = 0; i < N; ++i) {
+    const int c = card_index(deck[i]);
+    assert(unplaced >> c & 1);
+    const uint32_t digit = __builtin_popcount(unplaced & ((1u << c) - 1));
+    unplaced &= ~(1u << c);
+    if (i < N / 2) {
+      code.high = code.high * (N - i) + digit;
+    } else {
+      code.low = code.low * (N - i) + digit;
+    }
+  }
+  return code;
+}
+
+// Writes the six digits of v in the radices R, R - 1, ..., R - 5 to
+// digits[0..6), most significant first.  The radices are constants, so the
+// divisions are multiplications.
+template <uint32_t R>
+static inline void six_digits(uint32_t v, uint8_t digits[]) {
+  digits[5] = static_cast<uint8_t>(v % (R - 5));
+  v /= R - 5;
+  digits[4] = static_cast<uint8_t>(v % (R - 4));
+  v /= R - 4;
+  digits[3] = static_cast<uint8_t>(v % (R - 3));
+  v /= R - 3;
+  digits[2] = static_cast<uint8_t>(v % (R - 2));
+  v /= R - 2;
+  digits[1] = static_cast<uint8_t>(v % (R - 1));
+  digits[0] = static_cast<uint8_t>(v / (R - 1));
+}
+
+// The cards not yet placed are kept in order, as the bytes of each Card,
+// eight to a word from the low byte up.  KEEP[d + 16 - 8 * j] masks the
+// bytes of word j that stay put when byte d is removed; the bytes above
+// them move down one place.  Tables and shifts leave no branches for the
+// predictor to miss.
+struct Keep_masks {
+  uint64_t masks[40];
+
+  constexpr Keep_masks() : masks() {
+    for (int i = 0; i < 40; ++i) {
+      const int kept = i - 16 < 0 ? 0 : i - 16 > 8 ? 8 : i - 16;
+      masks[i] = kept == 8 ? ~0ull : (1ull << (8 * kept)) - 1;
+    }
+  }
+};
+
+static constexpr Keep_masks KEEP;
+
+// The whole pack in the order of Pack()
+struct Unplaced {
+  uint64_t words[3] = {0, 0, 0};
+
+  Unplaced() {
+    const Deck cards = Pack().get_cards();
+    for (int i = 0; i < N; ++i) {
+      uint8_t byte;
+      memcpy(&byte, &cards[i], 1);
+      words[i / 8] |= static_cast<uint64_t>(byte) << (8 * (i % 8));
+    }
+  }
+};
+
+static inline uint64_t remove_byte(uint64_t w, uint64_t next, int d, int j) {
+  const uint64_t keep = KEEP.masks[d + 16 - 8 * j];
+  return (w & keep) | (((w >> 8) | (next << 56)) & ~keep);
+}
+
+// The digits are split into four groups of six, whose radices multiply to
+// less than 2^32, so only the first split needs 64-bit arithmetic.  Each
+// card is then the digit'th of the cards not yet placed.
+Deck decode_deck(const Deck_code &code) {
+  const uint32_t RADICES_13_TO_18 = 13366080;   // 18! / 12!
+  const uint32_t RADICES_1_TO_6 = 720;          // 6!
+  uint8_t digits[N];
+  six_digits<24>(static_cast<uint32_t>(code.high / RADICES_13_TO_18), digits);
+  six_digits<18>(static_cast<uint32_t>(code.high % RADICES_13_TO_18),
+                 digits + 6);
+  six_digits<12>(code.low / RADICES_1_TO_6, digits + 12);
+  six_digits<6>(code.low % RADICES_1_TO_6, digits + 18);
+  static const Unplaced standard;
+  uint64_t w0 = standard.words[0], w1 = standard.words[1],
+    w2 = standard.words[2];
+  Deck deck;
+  for (int i = 0; i < N; ++i) {
+    const int d = digits[i];
+    const uint64_t words[] = {w0, w1, w2};
+    const uint8_t byte = static_cast<uint8_t>(words[d >> 3] >> (8 * (d & 7)));
+    memcpy(&deck[i], &byte, 1);
+    w0 = remove_byte(w0, w1, d, 0);
+    w1 = remove_byte(w1, w2, d, 1);
+    w2 = remove_byte(w2, 0, d, 2);
+  }
+  return deck;
+}
+
+Deck random_deck(uint64_t seed, uint64_t index) {
+  Rng rng(game_seed(seed, index));
+  Pack pack;
+  pack.shuffle(rng);
+  return pack.get_cards();
+}
+
+static void put_record(const Deck_code &code, unsigned char *out) {
+  const uint64_t bits = code.high << LOW_BITS | code.low;
+  const uint16_t top = static_cast<uint16_t>(code.high >> (64 - LOW_BITS));
+  memcpy(out, &bits, sizeof(bits));
+  memcpy(out + sizeof(bits), &top, sizeof(top));
+}
+
+static Deck_code get_record(const unsigned char *in) {
+  uint64_t bits;
+  uint16_t top;
+  memcpy(&bits, in, sizeof(bits));
+  memcpy(&top, in + sizeof(bits), sizeof(top));
+  Deck_code code;
+  code.low = static_cast<uint32_t>(bits & ((1u << LOW_BITS) - 1));
+  code.high = bits >> LOW_BITS | static_cast<uint64_t>(top) << (64 - LOW_BITS);
+  return code;
+}
+
+bool write_deck_corpus(const string &path, uint64_t n, uint64_t seed,
+                       unsigned threads) {
+  assert(threads >= 1);
+  ofstream out(path, ios::binary | ios::trunc);
+  const uint64_t header[] = {CORPUS_MAGIC, n};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+  // Each round, thread t encodes block t, and the blocks go out in order
+  const uint64_t BLOCK = 1 << 16;
+  vector<unsigned char> buffer(threads * BLOCK * RECORD_BYTES);
+  for (uint64_t first = 0; first < n && out; first += threads * BLOCK) {
+    const uint64_t last = min(n, first + threads * BLOCK);
+    auto encode = [&](unsigned t) {
+      const uint64_t from = first + t * BLOCK, to = min(last, from + BLOCK);
+      for (uint64_t i = from; i < to; ++i) {
+        put_record(encode_deck(random_deck(seed, i)),
+                   &buffer[(i - first) * RECORD_BYTES]);
+      }
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(encode, t);
+    encode(0);
+    for (thread &t : pool) t.join();
+    out.write(reinterpret_cast<const char *>(buffer.data()),
+              static_cast<streamsize>((last - first) * RECORD_BYTES));
+  }
+  out.close();
+  return !out.fail();
+}
+
+Deck_corpus::Deck_corpus(const string &path)
+  : file(path), records(nullptr), decks(0) {
+  if (!file.is_open() || file.size() < HEADER_BYTES) return;
+  uint64_t header[2];
+  memcpy(header, file.data(), sizeof(header));
+  if (header[0] != CORPUS_MAGIC
+      || file.size() != HEADER_BYTES + header[1] * RECORD_BYTES) {
+    return;
+  }
+  records = reinterpret_cast<const unsigned char *>(file.data()) + HEADER_BYTES;
+  decks = header[1];
+}
+
+bool Deck_corpus::is_open() const { return records != nullptr; }
+
+uint64_t Deck_corpus::size() const { return decks; }
+
+Deck_code Deck_corpus::code(uint64_t i) const {
+  assert(is_open() && i < decks);
+  return get_record(records + i * RECORD_BYTES);
+}
+
+void Deck_corpus::get(uint64_t i, Pack &pack) const {
+  pack = Pack(decode_deck(code(i)));
+}
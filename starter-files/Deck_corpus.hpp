@@ -0,0 +1,85 @@
+#ifndef DECK_CORPUS_HPP
+#define DECK_CORPUS_HPP
+/* Deck_corpus.hpp
+ *
+ * Compact storage of many deck orders, for reproducible benchmark and
+ * evaluation runs.
+ *
+ * A deck order is stored as its rank among all 24! orders of the euchre
+ * pack in lexicographic order, counting the cards in the order of Pack():
+ * the standard order has rank 0 and its reverse rank 24! - 1.  The rank
+ * needs 80 bits, and it is kept split as rank / 12! and rank % 12!, in 51
+ * and 29 bits, so that no arithmetic is wider than 64 bits.
+ *
+ * File layout, in host byte order: the 64-bit magic and number of decks,
+ * then each deck in ten bytes, the 64-bit word high << 29 | low followed by
+ * the 16-bit word high >> 35.  The file is memory-mapped for reading and
+ * any deck is decoded on its own.
+ */
+
+#include "Card.hpp"
+#include "MappedFile.hpp"
+#include "Pack.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+
+// The rank of a deck order, split at 12!
+struct Deck_code {
+  std::uint64_t high = 0;   // rank / 12!, less than 24! / 12!
+  std::uint32_t low = 0;    // rank % 12!
+};
+
+using Deck = std::array<Card, Pack::PACK_SIZE>;
+
+//REQUIRES deck holds each card of the euchre pack once
+//EFFECTS Returns the rank of the order of deck
+Deck_code encode_deck(const Deck &deck);
+
+//REQUIRES code is the rank of a deck order
+//EFFECTS Returns the deck order of rank code
+Deck decode_deck(const Deck_code &code);
+
+//EFFECTS Returns the order of the index'th deck of seed: the pack shuffled
+//  by Rng(game_seed(seed, index)), as simulate.exe shuffles the first deal
+//  of game index
+Deck random_deck(std::uint64_t seed, std::uint64_t index);
+
+//REQUIRES threads >= 1
+//MODIFIES the file at path
+//EFFECTS Writes random_deck(seed, i) for i in [0, n) to path, threads
+//  encoding blocks of decks in parallel.  Returns false if it cannot be
+//  written.
+bool write_deck_corpus(const std::string &path, std::uint64_t n,
+                       std::uint64_t seed, unsigned threads);
+
+class Deck_corpus {
+public:
+  // EFFECTS: Maps the corpus at path.  is_open() is false if it cannot be
+  //          mapped or is not a complete corpus.
+  explicit Deck_corpus(const std::string &path);
+
+  Deck_corpus(const Deck_corpus &) = delete;
+  Deck_corpus & operator=(const Deck_corpus &) = delete;
+
+  bool is_open() const;
+
+  // EFFECTS: Returns the number of decks
+  std::uint64_t size() const;
+
+  // REQUIRES: is_open() and i < size()
+  // EFFECTS: Returns the code of deck i
+  Deck_code code(std::uint64_t i) const;
+
+  // REQUIRES: is_open() and i < size()
+  // MODIFIES: pack
+  // EFFECTS: Makes pack deck i, with no cards dealt
+  void get(std::uint64_t i, Pack &pack) const;
+
+private:
+  MappedFile file;
+  const unsigned char *records;
+  std::uint64_t decks;
+};
+
+#endif // DECK_CORPUS_HPP
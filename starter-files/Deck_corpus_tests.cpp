@@ -0,0 +1,74 @@
+// Deck Corpus Tests
+#include "Deck_corpus.hpp"
+#include "Rng.hpp"
+#include "unit_test_framework.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static const char *const CORPUS = "Deck_corpus_tests.dk";
+
+static const uint64_t FACTORIAL_12 = 479001600;
+
+TEST(test_deck_rank_ends) {
+    Deck deck = Pack().get_cards();
+    Deck_code first = encode_deck(deck);
+    ASSERT_EQUAL(first.high, 0u);
+    ASSERT_EQUAL(first.low, 0u);
+
+    // 24! / 12! - 1 and 12! - 1
+    reverse(deck.begin(), deck.end());
+    Deck_code last = encode_deck(deck);
+    ASSERT_EQUAL(last.high, 1295295050649599ull);
+    ASSERT_EQUAL(last.low, FACTORIAL_12 - 1);
+    ASSERT_TRUE(decode_deck(last) == deck);
+}
+
+TEST(test_deck_rank_is_lexicographic) {
+    // Successive orders have successive ranks, carrying across 12!
+    int order[Pack::PACK_SIZE];
+    for (int i = 0; i < Pack::PACK_SIZE; ++i) order[i] = i;
+    reverse(order + 12, order + Pack::PACK_SIZE);
+    const Deck standard = Pack().get_cards();
+    uint64_t expected_high = 0, expected_low = FACTORIAL_12 - 1;
+    for (int step = 0; step < 1000; ++step) {
+        Deck deck;
+        for (int i = 0; i < Pack::PACK_SIZE; ++i) deck[i] = standard[order[i]];
+        Deck_code code = encode_deck(deck);
+        ASSERT_EQUAL(code.high, expected_high);
+        ASSERT_EQUAL(code.low, expected_low);
+        next_permutation(order, order + Pack::PACK_SIZE);
+        if (++expected_low == FACTORIAL_12) {
+            expected_low = 0;
+            ++expected_high;
+        }
+    }
+}
+
+TEST(test_deck_round_trip) {
+    for (uint64_t i = 0; i < 10000; ++i) {
+        Deck deck = random_deck(50, i);
+        ASSERT_TRUE(decode_deck(encode_deck(deck)) == deck);
+    }
+}
+
+TEST(test_deck_corpus_write_and_read) {
+    const uint64_t n = 70000;   // more than one block per thread
+    ASSERT_TRUE(write_deck_corpus(CORPUS, n, 51, 2));
+    Deck_corpus corpus(CORPUS);
+    ASSERT_TRUE(corpus.is_open());
+    ASSERT_EQUAL(corpus.size(), n);
+    Pack pack;
+    for (uint64_t i = 0; i < n; i += 7) {
+        pack.deal_one();
+        corpus.get(i, pack);
+        ASSERT_EQUAL(pack.get_next(), 0);
+        ASSERT_TRUE(pack.get_cards() == random_deck(51, i));
+    }
+    ASSERT_FALSE(Deck_corpus("no_such_file.dk").is_open());
+}
+
+TEST_MAIN()
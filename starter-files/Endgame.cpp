@@ -0,0 +1,374 @@
+// Endgame.cpp
+#include "Endgame.hpp"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+using namespace std;
+
+static const uint64_t TABLE_MAGIC = 0x314d47444e455545ULL; // "EUENDGM1"
+static const int MAX_TRICKS = Endgame_table::MAX_TRICKS;
+static const size_t HEADER_WORDS = 2 + MAX_TRICKS;
+static const int MAX_SUIT = 7;  // cards in the trump suit, with the left bower
+
+// Canonical numbering
+
+// One suit of a position: how many of its cards are left, and the seat
+// (counted from the leader) holding each, lowest card in the top digit
+struct Suit_string {
+  int n;
+  uint32_t seats;
+};
+
+static bool operator<(const Suit_string &a, const Suit_string &b) {
+  return a.n != b.n ? a.n < b.n : a.seats < b.seats;
+}
+
+// Tables behind the numbering, built once
+class Endgame_index {
+public:
+  Endgame_index();
+
+  // Cards of suit s when trump is trump, lowest first
+  Card order[4][4][MAX_SUIT];
+  int order_size[4][4];
+
+  // For each card bit when trump is trump, its suit counted from trump and
+  // its place in that suit's order
+  uint8_t suit_of[4][64];
+  uint8_t place_of[4][64];
+
+  // Sequences holding label l count[l] times, for up to MAX_TRICKS of each
+  uint64_t arrangements[MAX_TRICKS + 1][MAX_TRICKS + 1][MAX_TRICKS + 1]
+                      [MAX_TRICKS + 1];
+
+  // Per number of tricks, the shapes: the lengths of trump and of the
+  // three other suits, ascending.  shape_of numbers a shape by its first
+  // three lengths, or is -1.
+  static const int MAX_SHAPES = 64;
+  int shapes[MAX_TRICKS + 1];
+  int shape_of[MAX_TRICKS + 1][MAX_SUIT + 1][MAX_SUIT][MAX_SUIT];
+  int shape_lengths[MAX_TRICKS + 1][MAX_SHAPES][4];
+
+  // Canonical positions of k tricks
+  uint64_t positions(int k) const {
+    return static_cast<uint64_t>(shapes[k]) * arrangements[k][k][k][k];
+  }
+};
+
+Endgame_index::Endgame_index() {
+  for (int t = 0; t < 4; ++t) {
+    Suit trump = static_cast<Suit>(t);
+    for (int s = 0; s < 4; ++s) order_size[t][s] = 0;
+    for (int s = 0; s < 4; ++s) {
+      for (int r = NINE; r <= ACE; ++r) {
+        Card c(static_cast<Rank>(r), static_cast<Suit>(s));
+        int suit = c.get_suit(trump);
+        order[t][suit][order_size[t][suit]++] = c;
+      }
+    }
+    for (int s = 0; s < 4; ++s) {
+      sort(order[t][s], order[t][s] + order_size[t][s],
+           [trump](const Card &a, const Card &b) {
+             return Card_less(a, b, trump);
+           });
+      for (int i = 0; i < order_size[t][s]; ++i) {
+        const int bit = __builtin_ctzll(card_bit(order[t][s][i]));
+        suit_of[t][bit] = static_cast<uint8_t>((s - t + 4) % 4);
+        place_of[t][bit] = static_cast<uint8_t>(i);
+      }
+    }
+  }
+
+  // (c0 + c1 + c2 + c3)! / (c0! c1! c2! c3!), built up one label at a time
+  const int M = MAX_TRICKS;
+  for (int a = 0; a <= M; ++a) {
+    for (int b = 0; b <= M; ++b) {
+      for (int c = 0; c <= M; ++c) {
+        for (int d = 0; d <= M; ++d) {
+          uint64_t &n = arrangements[a][b][c][d];
+          n = (a + b + c + d == 0);
+          if (a) n += arrangements[a - 1][b][c][d];
+          if (b) n += arrangements[a][b - 1][c][d];
+          if (c) n += arrangements[a][b][c - 1][d];
+          if (d) n += arrangements[a][b][c][d - 1];
+        }
+      }
+    }
+  }
+
+  // Trump holds up to 7 cards and the other suits up to 6; the next suit
+  // holds only 5, but as the shortest of the three it never holds more
+  for (int k = 1; k <= M; ++k) {
+    shapes[k] = 0;
+    for (int t = 0; t <= MAX_SUIT; ++t) {
+      for (int a = 0; a < MAX_SUIT; ++a) {
+        for (int b = 0; b < MAX_SUIT; ++b) {
+          int c = 4 * k - t - a - b;
+          bool valid = a <= b && b <= c && c < MAX_SUIT;
+          shape_of[k][t][a][b] = valid ? shapes[k] : -1;
+          if (!valid) continue;
+          assert(shapes[k] < MAX_SHAPES);
+          int *len = shape_lengths[k][shapes[k]++];
+          len[0] = t;
+          len[1] = a;
+          len[2] = b;
+          len[3] = c;
+        }
+      }
+    }
+  }
+}
+
+static const Endgame_index & endgame_index() {
+  static const Endgame_index index;
+  return index;
+}
+
+// Rank of the sequence of labels among all sequences with its label counts
+static uint64_t sequence_rank(const Endgame_index &x, const int labels[],
+                              int k) {
+  int count[4] = {k, k, k, k};
+  uint64_t rank = 0;
+  for (int i = 0; i < 4 * k; ++i) {
+    for (int l = 0; l < labels[i]; ++l) {
+      if (!count[l]) continue;
+      --count[l];
+      rank += x.arrangements[count[0]][count[1]][count[2]][count[3]];
+      ++count[l];
+    }
+    --count[labels[i]];
+  }
+  return rank;
+}
+
+// Inverse of sequence_rank
+static void sequence_unrank(const Endgame_index &x, uint64_t rank, int k,
+                            int labels[]) {
+  int count[4] = {k, k, k, k};
+  for (int i = 0; i < 4 * k; ++i) {
+    for (int l = 0; ; ++l) {
+      if (!count[l]) continue;
+      --count[l];
+      uint64_t n = x.arrangements[count[0]][count[1]][count[2]][count[3]];
+      if (rank < n) {
+        labels[i] = l;
+        break;
+      }
+      rank -= n;
+      ++count[l];
+    }
+  }
+}
+
+// Number of the canonical position
+static uint64_t position_index(const Card_set hands[], Suit trump,
+                               int leader, int k) {
+  const Endgame_index &x = endgame_index();
+  // Seat of the card in each place of each suit, trump first
+  unsigned held[4] = {0, 0, 0, 0};  // bit i: the card in place i is held
+  uint32_t seat_at[4] = {0, 0, 0, 0};
+  for (int r = 0; r < 4; ++r) {
+    for (Card_set h = hands[(leader + r) % 4]; h; h &= h - 1) {
+      const int bit = __builtin_ctzll(h);
+      const int j = x.suit_of[trump][bit], i = x.place_of[trump][bit];
+      held[j] |= 1u << i;
+      seat_at[j] |= static_cast<uint32_t>(r) << 2 * i;
+    }
+  }
+  Suit_string suits[4];
+  for (int j = 0; j < 4; ++j) {
+    suits[j] = {0, 0};
+    for (unsigned h = held[j]; h; h &= h - 1) {
+      const int i = __builtin_ctz(h);
+      suits[j].seats = suits[j].seats << 2 | (seat_at[j] >> 2 * i & 3);
+      ++suits[j].n;
+    }
+  }
+  if (suits[2] < suits[1]) swap(suits[1], suits[2]);
+  if (suits[3] < suits[2]) swap(suits[2], suits[3]);
+  if (suits[2] < suits[1]) swap(suits[1], suits[2]);
+
+  int labels[4 * MAX_TRICKS];
+  int n = 0;
+  for (const Suit_string &str : suits) {
+    for (int i = str.n - 1; i >= 0; --i) labels[n++] = str.seats >> 2 * i & 3;
+  }
+  assert(n == 4 * k);
+  const int shape = x.shape_of[k][suits[0].n][suits[1].n][suits[2].n];
+  return static_cast<uint64_t>(shape) * x.arrangements[k][k][k][k] +
+         sequence_rank(x, labels, k);
+}
+
+// Tricks the leader's team takes, from a table of values for k tricks
+static int read_value(const uint8_t *values, uint64_t index) {
+  return values[index >> 2] >> 2 * (index & 3) & 3;
+}
+
+static int cards_each(const Card_set hands[], int leader) {
+  return __builtin_popcountll(hands[leader]);
+}
+
+// Search
+
+// Minimax over one trick, with the tricks after it looked up in tables or,
+// without tables, searched the same way
+class Endgame_search {
+public:
+  Endgame_search(const Card_set hands_in[], Suit trump_in, int leader_in,
+                 const uint8_t *const *tables_in)
+    : trump(trump_in), leader(leader_in),
+      k(cards_each(hands_in, leader_in)), tables(tables_in) {
+    for (int i = 0; i < 4; ++i) hands[i] = hands_in[i];
+  }
+
+  //EFFECTS Returns the value of the position, if it lies in
+  //  (alpha, beta); otherwise a bound on the far side of that window
+  int best(int step, int alpha, int beta) {
+    const int seat = (leader + step) % 4;
+    const bool ours = step % 2 == 0;  // the leader's team plays
+    Card_set options = step == 0 ? hands[seat]
+                                 : legal_plays(hands[seat], trick[0], trump);
+    int value = ours ? -1 : k + 1;
+    while (options) {
+      const int bit_index = __builtin_ctzll(options);
+      const Card_set bit = options & -options;
+      options &= options - 1;
+      trick[step] = Card(static_cast<Rank>(bit_index / 4),
+                         static_cast<Suit>(bit_index % 4));
+      hands[seat] &= ~bit;
+      const int v = step == 3 ? after_trick() : best(step + 1, alpha, beta);
+      hands[seat] |= bit;
+      if (ours) {
+        value = max(value, v);
+        alpha = max(alpha, v);
+      } else {
+        value = min(value, v);
+        beta = min(beta, v);
+      }
+      if (alpha >= beta) break;
+    }
+    return value;
+  }
+
+private:
+  // Value once the trick in trick[] is complete
+  int after_trick() const {
+    const int winner = (leader + trick_winner(trick, trump)) % 4;
+    int later = 0;  // tricks winner's team takes after this one
+    if (k > 1 && tables) {
+      later = read_value(tables[k - 1],
+                         position_index(hands, trump, winner, k - 1));
+    } else if (k > 1) {
+      later = solve_endgame(hands, trump, winner);
+    }
+    return winner % 2 == leader % 2 ? 1 + later : k - 1 - later;
+  }
+
+  Card_set hands[4];
+  Suit trump;
+  int leader;
+  int k;
+  const uint8_t *const *tables;
+  Card trick[4];
+};
+
+int solve_endgame(const Card_set hands[], Suit trump, int leader) {
+  Endgame_search search(hands, trump, leader, nullptr);
+  return search.best(0, -1, cards_each(hands, leader) + 1);
+}
+
+// Generation
+
+// Values of every canonical position of k tricks, four to a byte
+static vector<uint8_t> solve_all(int k, const uint8_t *const tables[]) {
+  const Endgame_index &x = endgame_index();
+  const uint64_t per_shape = x.arrangements[k][k][k][k];
+  vector<uint8_t> values((x.positions(k) + 31) / 32 * 8, 0);
+  // Trump is spades; the shortest other suit takes the next suit, clubs,
+  // which lacks its jack.  Each suit is dealt from its lowest cards.
+  const Suit suit_of[4] = {SPADES, CLUBS, HEARTS, DIAMONDS};
+  for (int shape = 0; shape < x.shapes[k]; ++shape) {
+    const int *len = x.shape_lengths[k][shape];
+    for (uint64_t rank = 0; rank < per_shape; ++rank) {
+      int labels[4 * MAX_TRICKS];
+      sequence_unrank(x, rank, k, labels);
+      Card_set hands[4] = {0, 0, 0, 0};
+      Suit_string suits[4];
+      for (int j = 0, n = 0; j < 4; ++j) {
+        suits[j] = {len[j], 0};
+        for (int i = 0; i < len[j]; ++i, ++n) {
+          suits[j].seats = suits[j].seats << 2 | static_cast<uint32_t>(labels[n]);
+          hands[labels[n]] |= card_bit(x.order[SPADES][suit_of[j]][i]);
+        }
+      }
+      // Positions whose equal-length suits are out of order never occur
+      if (suits[2] < suits[1] || suits[3] < suits[2]) continue;
+      Endgame_search search(hands, SPADES, 0, tables);
+      const uint64_t index = static_cast<uint64_t>(shape) * per_shape + rank;
+      values[index >> 2] |= static_cast<uint8_t>(search.best(0, -1, k + 1)
+                                                 << 2 * (index & 3));
+    }
+  }
+  return values;
+}
+
+bool write_endgame_table(const string &path, int max_tricks) {
+  assert(1 <= max_tricks && max_tricks <= MAX_TRICKS);
+  const Endgame_index &x = endgame_index();
+  vector<uint8_t> values[MAX_TRICKS + 1];
+  const uint8_t *tables[MAX_TRICKS + 1] = {};
+  for (int k = 1; k <= max_tricks; ++k) {
+    values[k] = solve_all(k, tables);
+    tables[k] = values[k].data();
+  }
+
+  ofstream out(path, ios::binary | ios::trunc);
+  uint64_t header[HEADER_WORDS] = {TABLE_MAGIC,
+                                   static_cast<uint64_t>(max_tricks)};
+  for (int k = 1; k <= max_tricks; ++k) header[1 + k] = x.positions(k);
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  for (int k = 1; k <= max_tricks; ++k) {
+    out.write(reinterpret_cast<const char *>(values[k].data()),
+              static_cast<streamsize>(values[k].size()));
+  }
+  out.close();
+  return !out.fail();
+}
+
+// Lookup
+
+Endgame_table::Endgame_table(const string &path)
+  : file(path), values(), most_tricks(0) {
+  if (!file.is_open() || file.size() < HEADER_WORDS * sizeof(uint64_t)) {
+    return;
+  }
+  const Endgame_index &x = endgame_index();
+  // Mappings are page-aligned, so the words can be read in place
+  const uint64_t *w = reinterpret_cast<const uint64_t *>(file.data());
+  if (w[0] != TABLE_MAGIC || w[1] < 1 || w[1] > MAX_TRICKS) return;
+  const int max = static_cast<int>(w[1]);
+  size_t offset = HEADER_WORDS * sizeof(uint64_t);
+  for (int k = 1; k <= max; ++k) {
+    if (w[1 + k] != x.positions(k)) return;
+    values[k] = reinterpret_cast<const uint8_t *>(file.data()) + offset;
+    offset += (x.positions(k) + 31) / 32 * 8;
+  }
+  if (offset != file.size()) return;
+  most_tricks = max;
+}
+
+bool Endgame_table::is_open() const { return most_tricks > 0; }
+
+int Endgame_table::max_tricks() const { return most_tricks; }
+
+int Endgame_table::lookup(const Card_set hands[], Suit trump,
+                          int leader) const {
+  const int k = cards_each(hands, leader);
+  assert(1 <= k && k <= most_tricks);
+  return read_value(values[k], position_index(hands, trump, leader, k));
+}
+
+int Endgame_table::lookup(const Hand_state &s) const {
+  return lookup(s.hands, s.info.get_trump(), s.to_play);
+}
@@ -0,0 +1,78 @@
+#ifndef ENDGAME_HPP
+#define ENDGAME_HPP
+/* Endgame.hpp
+ *
+ * Exact values of the last tricks of a hand, solved once and looked up.
+ *
+ * A position is four seats holding the same number of cards, one to three,
+ * a trump suit and the seat to lead.  Its value is the number of the tricks
+ * left that the leader's team takes when all four seats play their best,
+ * each seeing every hand.
+ *
+ * Only the order of the cards left within each suit counts, with the left
+ * bower counted as a trump, so every position is first reduced to a
+ * canonical one: seats are numbered from the leader, each suit becomes the
+ * list of seats holding its cards from lowest to highest, trump comes first
+ * and the three other suits, which are now alike, are sorted.  The
+ * canonical positions are numbered densely from the lengths of the suits and
+ * the rank of the sequence of seats, so a lookup is a handful of integer
+ * operations and a read of two bits.
+ *
+ * File layout, all 64-bit words in host byte order: magic, the most tricks
+ * solved, and for one to three tricks the number of positions; then per
+ * number of tricks the values, four to a byte, padded to a whole word.
+ */
+
+#include "Card.hpp"
+#include "Game.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//REQUIRES every seat holds the same number of cards, at least one, and no
+//  card is held twice
+//EFFECTS Searches every line of play and returns the number of tricks left
+//  that leader's team takes.  The cost grows steeply with the number of
+//  cards; use an Endgame_table for up to MAX_TRICKS tricks.
+int solve_endgame(const Card_set hands[], Suit trump, int leader);
+
+//REQUIRES 1 <= max_tricks <= Endgame_table::MAX_TRICKS
+//MODIFIES the file at path
+//EFFECTS Solves every canonical position of up to max_tricks tricks and
+//  writes the table to path.  Returns false if it cannot be written.
+bool write_endgame_table(const std::string &path, int max_tricks);
+
+class Endgame_table {
+public:
+  static const int MAX_TRICKS = 3;
+
+  // EFFECTS: Maps the table at path.  is_open() is false if it cannot be
+  //          mapped or is not a complete table.
+  explicit Endgame_table(const std::string &path);
+
+  Endgame_table(const Endgame_table &) = delete;
+  Endgame_table & operator=(const Endgame_table &) = delete;
+
+  bool is_open() const;
+
+  // EFFECTS: Returns the most tricks the table has solved
+  int max_tricks() const;
+
+  // REQUIRES: is_open(); every seat holds the same number of cards, at
+  //           least one and at most max_tricks(), and no card is held twice
+  // EFFECTS: Returns solve_endgame(hands, trump, leader)
+  int lookup(const Card_set hands[], Suit trump, int leader) const;
+
+  // REQUIRES: s is between tricks, nobody sits out, and at most
+  //           max_tricks() tricks are left
+  // EFFECTS: Returns the tricks left that s.to_play's team takes
+  int lookup(const Hand_state &s) const;
+
+private:
+  MappedFile file;
+  const std::uint8_t *values[MAX_TRICKS + 1];
+  int most_tricks;
+};
+
+#endif // ENDGAME_HPP
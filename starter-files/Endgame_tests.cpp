@@ -0,0 +1,107 @@
+// Endgame Tests
+#include "Endgame.hpp"
+#include "Pack.hpp"
+#include "Rng.hpp"
+#include "unit_test_framework.hpp"
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Each test writes its own table, since under -j another test may still
+// have a table mapped while one is rewritten
+static const char *const SEARCH_TABLE = "Endgame_tests_search.tb";
+static const char *const BOWER_TABLE = "Endgame_tests_bower.tb";
+static const char *const HAND_STATE_TABLE = "Endgame_tests_hand_state.tb";
+
+// Deals k random cards to each seat
+static void deal(Rng &rng, int k, Card_set hands[]) {
+    Pack pack;
+    pack.shuffle(rng);
+    for (int seat = 0; seat < 4; ++seat) {
+        hands[seat] = 0;
+        for (int i = 0; i < k; ++i) hands[seat] |= card_bit(pack.deal_one());
+    }
+}
+
+// Swaps the cards of suits a and b
+static Card_set swap_suits(Card_set cards, Suit a, Suit b) {
+    Card_set out = 0;
+    for (int r = NINE; r <= ACE; ++r) {
+        for (int s = 0; s < 4; ++s) {
+            Card c(static_cast<Rank>(r), static_cast<Suit>(s));
+            if (!(cards & card_bit(c))) continue;
+            Suit to = s == a ? b : s == b ? a : static_cast<Suit>(s);
+            out |= card_bit(Card(static_cast<Rank>(r), to));
+        }
+    }
+    return out;
+}
+
+TEST(test_endgame_lookups_match_search) {
+    ASSERT_TRUE(write_endgame_table(SEARCH_TABLE, 2));
+    Endgame_table table(SEARCH_TABLE);
+    ASSERT_TRUE(table.is_open());
+    ASSERT_EQUAL(table.max_tricks(), 2);
+    Rng rng(46);
+    for (int i = 0; i < 2000; ++i) {
+        Card_set hands[4];
+        deal(rng, 1 + i % 2, hands);
+        Suit trump = static_cast<Suit>(rng.below(4));
+        int leader = rng.below(4);
+        ASSERT_EQUAL(table.lookup(hands, trump, leader),
+                     solve_endgame(hands, trump, leader));
+    }
+}
+
+TEST(test_endgame_search_ignores_suit_names_and_seats) {
+    Rng rng(47);
+    for (int i = 0; i < 200; ++i) {
+        Card_set hands[4], swapped[4], rotated[4];
+        deal(rng, 3, hands);
+        for (int seat = 0; seat < 4; ++seat) {
+            // Hearts and diamonds are alike when spades are trump
+            swapped[seat] = swap_suits(hands[seat], HEARTS, DIAMONDS);
+            rotated[(seat + 1) % 4] = hands[seat];
+        }
+        int value = solve_endgame(hands, SPADES, 0);
+        ASSERT_TRUE(value >= 0 && value <= 3);
+        ASSERT_EQUAL(solve_endgame(swapped, SPADES, 0), value);
+        ASSERT_EQUAL(solve_endgame(rotated, SPADES, 1), value);
+    }
+}
+
+TEST(test_endgame_right_bower_takes_the_last_trick) {
+    ASSERT_TRUE(write_endgame_table(BOWER_TABLE, 1));
+    Endgame_table table(BOWER_TABLE);
+    // Seat 1 leads the Ace of Hearts; seat 2 trumps it with the right bower
+    Card_set hands[4] = {card_bit(Card(NINE, HEARTS)),
+                         card_bit(Card(ACE, HEARTS)),
+                         card_bit(Card(JACK, SPADES)),
+                         card_bit(Card(TEN, CLUBS))};
+    ASSERT_EQUAL(table.lookup(hands, SPADES, 1), 0);
+    ASSERT_EQUAL(table.lookup(hands, HEARTS, 1), 1);
+    ASSERT_EQUAL(table.lookup(hands, SPADES, 2), 1);
+}
+
+TEST(test_endgame_lookup_of_hand_state) {
+    ASSERT_TRUE(write_endgame_table(HAND_STATE_TABLE, 2));
+    Endgame_table table(HAND_STATE_TABLE);
+    Rng rng(48);
+    Card_set hands[4];
+    deal(rng, 2, hands);
+    Info_set info;
+    info.begin_hand(3, Card(NINE, SPADES));
+    info.make_trump(1, CLUBS, false);
+    Hand_state s = start_play(info, hands);
+    ASSERT_EQUAL(s.to_play, 0);
+    ASSERT_EQUAL(table.lookup(s), solve_endgame(hands, CLUBS, 0));
+}
+
+TEST(test_endgame_table_rejects_other_files) {
+    Endgame_table table("pack.in");
+    ASSERT_FALSE(table.is_open());
+}
+
+TEST_MAIN()
@@ -0,0 +1,48 @@
+// Euchre.cpp
+#include "Euchre.hpp"
+#include <cassert>
+
+using namespace std;
+
+Game::Game(const Pack &pack, Player *const players_in[],
+           const Game_config &config_in)
+  : game_state{pack}, config(config_in), obs(&quiet), random_deals(false) {
+  for (int i = 0; i < 4; ++i) players[i] = players_in[i];
+}
+
+Game::Game(uint64_t seed, Player *const players_in[],
+           const Game_config &config_in)
+  : config(config_in), obs(&quiet), rng(seed), random_deals(true) {
+  for (int i = 0; i < 4; ++i) players[i] = players_in[i];
+}
+
+void Game::set_observer(Game_observer &obs_in) {
+  obs = &obs_in;
+}
+
+bool Game::over() const {
+  return game_over(game_state, config);
+}
+
+Hand_result Game::play_hand() {
+  assert(!over());
+  if (random_deals) game_state.pack.shuffle(rng);
+  Hand_result hr = ::play_hand(game_state, players, config, *obs);
+  if (over()) obs->game_end(result().winner);
+  return hr;
+}
+
+Game_result Game::play() {
+  while (!over()) play_hand();
+  return result();
+}
+
+Game_result Game::result() const {
+  assert(over());
+  Game_result r;
+  r.winner = game_state.score[0] >= config.points_to_win ? 0 : 1;
+  r.score[0] = game_state.score[0];
+  r.score[1] = game_state.score[1];
+  r.hands = game_state.hand;
+  return r;
+}
@@ -0,0 +1,85 @@
+#ifndef EUCHRE_HPP
+#define EUCHRE_HPP
+/* Euchre.hpp
+ *
+ * Public header of libeuchre.a, the engine as a library.  A program that
+ * links it plays games in-process through a Game object instead of running
+ * euchre.exe and reading its transcript:
+ *
+ *   Player *players[4] = ...;
+ *   Game game(Pack(pack_file), players);
+ *   Game_result result = game.play();
+ *
+ * The library holds everything declared in Card.hpp, Pack.hpp, Player.hpp,
+ * Game.hpp and Game_spec.hpp, so a Game_observer such as Transcript can be
+ * attached to watch the game as it is played.
+ */
+
+#include "Card.hpp"
+#include "Game.hpp"
+#include "Game_spec.hpp"
+#include "Pack.hpp"
+#include "Player.hpp"
+#include "Rng.hpp"
+#include <cstdint>
+
+// How a game ended
+struct Game_result {
+  int winner = -1;        // team that won, 0 (seats 0 and 2) or 1
+  int score[2] = {0, 0};  // points per team
+  int hands = 0;          // hands played
+};
+
+class Game {
+public:
+  //REQUIRES players holds four players with empty hands that outlive the
+  //  Game
+  //EFFECTS Seats players for a game dealt from pack, which is reset or
+  //  shuffled before each hand as config says
+  Game(const Pack &pack, Player *const players[],
+       const Game_config &config = Game_config());
+
+  //REQUIRES players holds four players with empty hands that outlive the
+  //  Game
+  //EFFECTS Seats players for a game in which every hand is dealt from a
+  //  fresh random order of the pack, drawn from seed as simulate.exe does
+  Game(std::uint64_t seed, Player *const players[],
+       const Game_config &config = Game_config());
+
+  Game(const Game &) = delete;
+  Game & operator=(const Game &) = delete;
+
+  //REQUIRES obs outlives the Game
+  //EFFECTS Reports every event from now on to obs instead of nowhere
+  void set_observer(Game_observer &obs);
+
+  //EFFECTS Returns true if a team has enough points to win
+  bool over() const;
+
+  //REQUIRES !over()
+  //EFFECTS Plays the next hand and returns its outcome.  Throws
+  //  Illegal_play if a player breaks a rule and config.referee aborts.
+  Hand_result play_hand();
+
+  //EFFECTS Plays hands until over(), then returns result().  Throws
+  //  Illegal_play as play_hand does.
+  Game_result play();
+
+  //REQUIRES over()
+  //EFFECTS Returns how the game ended
+  Game_result result() const;
+
+  //EFFECTS Returns the score, dealer, pack and history so far
+  const Game_state & state() const { return game_state; }
+
+private:
+  Game_state game_state;
+  Player *players[4];
+  Game_config config;
+  Game_observer quiet;
+  Game_observer *obs;
+  Rng rng;
+  bool random_deals;
+};
+
+#endif // EUCHRE_HPP
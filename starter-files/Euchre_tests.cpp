@@ -0,0 +1,77 @@
+// Euchre library Tests
+#include "Euchre.hpp"
+#include "unit_test_framework.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// Four Simple players, seated like euchre_test01
+class Simple_table {
+public:
+    Simple_table() {
+        const char *const names[] = {"Edsger", "Fran", "Gabriel", "Herb"};
+        for (int i = 0; i < 4; ++i) players[i] = Player_factory(names[i], "Simple");
+    }
+    ~Simple_table() {
+        for (Player *p : players) delete p;
+    }
+    Player *players[4];
+};
+
+static Pack read_pack() {
+    ifstream fin("pack.in");
+    ASSERT_TRUE(fin.is_open());
+    return Pack(fin);
+}
+
+TEST(test_game_transcript_matches_euchre_exe) {
+    Simple_table table;
+    Game_config config;
+    config.shuffle = true;
+    Game game(read_pack(), table.players, config);
+    ostringstream transcript;
+    Transcript obs(transcript, table.players);
+    game.set_observer(obs);
+    Game_result r = game.play();
+
+    // The reference transcript without its command line
+    ifstream fin("euchre_test01.out.correct");
+    string command;
+    getline(fin, command);
+    ostringstream expected;
+    expected << fin.rdbuf();
+    ASSERT_EQUAL(transcript.str(), expected.str());
+    ASSERT_EQUAL(r.winner, game.state().score[0] >= 10 ? 0 : 1);
+    ASSERT_EQUAL(r.hands, game.state().hand);
+}
+
+TEST(test_game_hand_by_hand_matches_play) {
+    Simple_table a, b;
+    Game whole(7, a.players), stepped(7, b.players);
+    Game_result r = whole.play();
+    int points[2] = {0, 0};
+    while (!stepped.over()) {
+        Hand_result hr = stepped.play_hand();
+        points[0] += hr.points[0];
+        points[1] += hr.points[1];
+    }
+    Game_result s = stepped.result();
+    ASSERT_EQUAL(s.winner, r.winner);
+    ASSERT_EQUAL(s.hands, r.hands);
+    ASSERT_EQUAL(s.score[0], points[0]);
+    ASSERT_EQUAL(s.score[1], points[1]);
+    ASSERT_TRUE(s.score[r.winner] >= 10);
+}
+
+TEST(test_game_seeds_deal_differently) {
+    Simple_table a, b;
+    Game first(1, a.players), second(2, b.players);
+    Hand_result x = first.play_hand(), y = second.play_hand();
+    ASSERT_NOT_EQUAL(x.upcard, y.upcard);
+}
+
+TEST_MAIN()
@@ -0,0 +1,550 @@
+// Game.cpp
+#include "Game.hpp"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+static string illegal_play_message(int seat, const Card &card) {
+  ostringstream os;
+  os << "illegal play of " << card << " by seat " << seat;
+  return os.str();
+}
+
+Illegal_play::Illegal_play(int seat_in, const Card &card_in)
+  : runtime_error(illegal_play_message(seat_in, card_in)),
+    seat(seat_in), card(card_in) {}
+
+// Transcript
+
+Transcript::Transcript(ostream &os_in, Player *const players_in[])
+  : os(os_in), players(players_in) {
+  // Team names are built once per game rather than once per hand.
+  team_names[0] = players[0]->get_name() + " and " + players[2]->get_name();
+  team_names[1] = players[1]->get_name() + " and " + players[3]->get_name();
+}
+
+void Transcript::hand_begin(int hand, int dealer) {
+  if (hand > 0) os << '\n'; // blank line between hands
+  os << "Hand " << hand << '\n';
+  os << *players[dealer] << " deals\n";
+}
+
+void Transcript::upcard(const Card &upcard) {
+  os << upcard << " turned up\n";
+}
+
+void Transcript::pass(int seat) {
+  os << *players[seat] << " passes\n";
+}
+
+void Transcript::order_up(int seat, Suit trump) {
+  os << *players[seat] << " orders up " << trump << '\n';
+}
+
+void Transcript::going_alone(int seat) {
+  os << *players[seat] << " goes alone\n";
+}
+
+void Transcript::defending_alone(int seat) {
+  os << *players[seat] << " defends alone\n";
+}
+
+void Transcript::bidding_end() {
+  // Extra blank line after make/discard completes
+  os << '\n';
+}
+
+void Transcript::card_led(int seat, const Card &card) {
+  os << card << " led by " << *players[seat] << '\n';
+}
+
+void Transcript::card_played(int seat, const Card &card) {
+  os << card << " played by " << *players[seat] << '\n';
+}
+
+void Transcript::illegal_play(int seat, const Card &card) {
+  os << "Illegal play of " << card << " by " << *players[seat] << '\n';
+}
+
+void Transcript::trick_won(int seat) {
+  os << *players[seat] << " takes the trick\n\n";
+}
+
+void Transcript::hand_end(const Hand_result &result, const Game_state &state) {
+  bool team0_won_hand = (result.tricks[0] > result.tricks[1]);
+  if (result.thrown_in) {
+    os << "Hand thrown in\n";
+  } else {
+    os << team_names[team0_won_hand ? 0 : 1] << " win the hand\n";
+  }
+  if (result.march)   os << "march!\n";
+  if (result.euchred) os << "euchred!\n";
+
+  os << team_names[0] << " have " << state.score[0] << " points\n";
+  os << team_names[1] << " have " << state.score[1] << " points\n";
+}
+
+void Transcript::game_end(int team) {
+  os << '\n' << team_names[team] << " win!\n";
+}
+
+// Referee
+
+// Checks every lead and play against the cards each seat was dealt, kept as
+// Card_sets so that a check is a few integer operations.  The dealer's
+// discard is never shown to the engine, so after a pickup the dealer's set
+// holds six cards.  When the only card that could have followed suit may be
+// that discard, the play is allowed and the card becomes a suspect: playing
+// it later proves the renege, which is then too late to replay.
+class Referee {
+public:
+  Referee(Referee_policy policy_in, Hand_result &hr_in, Game_observer &obs_in)
+    : policy(policy_in), hr(hr_in), obs(obs_in) {}
+
+  void deal(int seat, const Card &c) { hands[seat] |= card_bit(c); }
+
+  // The cards dealt so far, indexed by seat
+  const Card_set * dealt() const { return hands; }
+
+  //REQUIRES hr.upcard is set
+  void pick_up(int dealer) {
+    hands[dealer] |= card_bit(hr.upcard);
+    hidden_discard = dealer;
+  }
+
+  //MODIFIES player, hr, obs
+  //EFFECTS Asks player, in seat, to lead (led is null) or to follow led
+  //  until the policy accepts a card, reports that card and returns it
+  Card take(Player *player, int seat, const Card *led) {
+    const int MAX_ATTEMPTS = 3;
+    for (int attempt = 1; ; ++attempt) {
+      Card c = led ? player->play_card(*led, hr.trump)
+                   : player->lead_card(hr.trump);
+      Card_set bit = card_bit(c);
+      if (bit & suspects[seat]) {
+        // c could have followed suit earlier in the hand
+        obs.illegal_play(seat, c);
+        punish(seat, c);
+      }
+      if (is_legal(seat, bit, led)) {
+        accept(seat, c, led);
+        return c;
+      }
+      obs.illegal_play(seat, c);
+      if (policy == REFEREE_PENALTY) {
+        punish(seat, c);
+        accept(seat, c, led);
+        return c;
+      }
+      if (policy == REFEREE_ABORT || attempt == MAX_ATTEMPTS) {
+        throw Illegal_play(seat, c);
+      }
+      if (hands[seat] & bit) player->add_card(c);  // hand it back
+    }
+  }
+
+private:
+  bool is_legal(int seat, Card_set bit, const Card *led) const {
+    if (!(hands[seat] & bit)) return false;
+    if (!led) return true;
+    Card_set follow = following(seat, *led);
+    if (!follow || (follow & bit)) return true;
+    // Legal only if the one card that could follow may have been discarded
+    return seat == hidden_discard && !(follow & (follow - 1));
+  }
+
+  void accept(int seat, const Card &c, const Card *led) {
+    Card_set bit = card_bit(c);
+    if (led && seat == hidden_discard) {
+      Card_set follow = following(seat, *led);
+      if (!(follow & bit)) suspects[seat] |= follow;
+    }
+    hands[seat] &= ~bit;
+    suspects[seat] &= ~bit;
+    if (led) {
+      obs.card_played(seat, c);
+    } else {
+      obs.card_led(seat, c);
+    }
+  }
+
+  // A renege that cannot be replayed is always a penalty unless aborting
+  void punish(int seat, const Card &c) {
+    if (policy == REFEREE_ABORT) throw Illegal_play(seat, c);
+    ++hr.reneges[seat % 2];
+  }
+
+  Card_set following(int seat, const Card &led) const {
+    return hands[seat] & suit_cards(led.get_suit(hr.trump), hr.trump);
+  }
+
+  Referee_policy policy;
+  Hand_result &hr;
+  Game_observer &obs;
+  Card_set hands[4] = {0, 0, 0, 0};
+  Card_set suspects[4] = {0, 0, 0, 0};
+  int hidden_discard = -1;  // seat of a dealer who picked up
+};
+
+// Engine
+
+// Deal 3-2-3-2 then 2-3-2-3, starting left of dealer.
+static void deal_hand(Pack &pack, Player *const players[], int dealer_seat,
+                      Referee &referee) {
+  int seat = (dealer_seat + 1) % 4;
+
+  // First pass: 3-2-3-2
+  for (int i = 0; i < 4; ++i) {
+    int num = (i % 2 == 0) ? 3 : 2;
+    for (int j = 0; j < num; ++j) {
+      Card c = pack.deal_one();
+      players[seat]->add_card(c);
+      referee.deal(seat, c);
+    }
+    seat = (seat + 1) % 4;
+  }
+
+  // Second pass: 2-3-2-3
+  seat = (dealer_seat + 1) % 4;
+  for (int i = 0; i < 4; ++i) {
+    int num = (i % 2 == 0) ? 2 : 3;
+    for (int j = 0; j < num; ++j) {
+      Card c = pack.deal_one();
+      players[seat]->add_card(c);
+      referee.deal(seat, c);
+    }
+    seat = (seat + 1) % 4;
+  }
+}
+
+// Position (0 to n-1) of the card that wins a trick of n cards
+static int trick_winner(const Card cards[], int n, Suit trump) {
+  int winner = 0;
+  for (int i = 1; i < n; ++i) {
+    if (Card_less(cards[winner], cards[i], cards[0], trump)) {
+      winner = i;
+    }
+  }
+  return winner;
+}
+
+int trick_winner(const Card cards[], Suit trump) {
+  return trick_winner(cards, 4, trump);
+}
+
+// Plays a single trick through the referee, which reports every card, and
+// records it in info; returns winner seat.
+template <class R>
+static int play_trick(Player *const players[], int leader_seat,
+                      Referee &referee, Info_set &info) {
+  Card cards[4];
+  int seats[4];
+  int n = 0;
+
+  for (int step = 0; step < 4; ++step) {
+    int pi = (leader_seat + step) % 4;
+    if constexpr (R::going_alone) {
+      if (info.sits_out(pi)) continue;
+    }
+    seats[n] = pi;
+    cards[n] = referee.take(players[pi], pi, n == 0 ? nullptr : &cards[0]);
+    info.play(pi, cards[n]);
+    ++n;
+  }
+
+  return seats[trick_winner(cards, n, info.get_trump())];
+}
+
+// Round 1: try ordering up the upcard suit
+static bool try_round_one(Player *const P[], Hand_result &hr,
+                          Game_observer &obs, Info_set &info) {
+  for (int i = 1; i <= 4; ++i) {
+    int p = (hr.dealer + i) % 4;
+    Suit dummy;
+    if (P[p]->make_trump(hr.upcard, p == hr.dealer, 1, dummy)) {
+      hr.trump = hr.upcard.get_suit();
+      hr.maker = p;
+      hr.round = 1;
+      info.make_trump(p, hr.trump, true);
+      obs.order_up(p, hr.trump);
+      return true;
+    }
+    obs.pass(p);
+  }
+  return false;
+}
+
+// Round 2: naming next suit.  Being the dealer only matters here because
+// the dealer is stuck, so without stick-the-dealer nobody is told.
+template <class R>
+static bool try_round_two(Player *const P[], Hand_result &hr,
+                          Game_observer &obs, Info_set &info) {
+  for (int i = 1; i <= 4; ++i) {
+    int p = (hr.dealer + i) % 4;
+    Suit chosen;
+    if (P[p]->make_trump(hr.upcard, R::stick_the_dealer && p == hr.dealer,
+                         2, chosen)) {
+      hr.trump = chosen;
+      hr.maker = p;
+      hr.round = 2;
+      info.make_trump(p, hr.trump, false);
+      obs.order_up(p, hr.trump);
+      return true;
+    }
+    obs.pass(p);
+  }
+  return false;
+}
+
+// Round 3: screw the dealer
+static void screw_the_dealer(Hand_result &hr, Game_observer &obs,
+                             Info_set &info) {
+  hr.maker = hr.dealer;
+  hr.trump = Suit_next(hr.upcard.get_suit());
+  hr.round = 3;
+  info.make_trump(hr.maker, hr.trump, false);
+  obs.order_up(hr.dealer, hr.trump);
+}
+
+// The maker may go alone, and then a defender may defend alone.  Their
+// partners sit the hand out.
+template <class R>
+static void choose_alone(Player *const P[], Hand_result &hr,
+                         Game_observer &obs, Info_set &info) {
+  if (!P[hr.maker]->go_alone(hr.trump)) return;
+  hr.alone = hr.maker;
+  info.sit_out((hr.maker + 2) % 4);
+  obs.going_alone(hr.maker);
+
+  if constexpr (R::defend_alone) {
+    for (int i = 1; i <= 3; i += 2) {
+      int d = (hr.maker + i) % 4;
+      if (P[d]->defend_alone(hr.trump)) {
+        hr.defending_alone = d;
+        info.sit_out((d + 2) % 4);
+        obs.defending_alone(d);
+        return;
+      }
+    }
+  }
+}
+
+// Awards points for the tricks in hr to the teams in hr and state.
+template <class R>
+static void score_hand(Hand_result &hr, Game_state &state) {
+  int makers = hr.maker % 2;
+  int maker_tricks = hr.tricks[makers];
+  hr.march = (maker_tricks == 5);
+  hr.euchred = (maker_tricks <= 2);
+
+  if (hr.march) {
+    hr.points[makers] = (R::going_alone && hr.alone != -1) ? 4 : 2;
+  } else if (hr.euchred) {
+    hr.points[1 - makers] =
+      (R::defend_alone && hr.defending_alone != -1) ? 4 : 2;
+  } else {
+    hr.points[makers] = 1;
+  }
+  // Each renege gives the other team 2 points
+  hr.points[0] += 2 * hr.reneges[1];
+  hr.points[1] += 2 * hr.reneges[0];
+  state.score[0] += hr.points[0];
+  state.score[1] += hr.points[1];
+}
+
+template <class R>
+Hand_result play_hand(Game_state &state, Player *const players[],
+                      const Game_config &config, Game_observer &obs) {
+  Hand_result hr;
+  hr.dealer = state.dealer;
+  obs.hand_begin(state.hand, state.dealer);
+
+  // Shuffle policy
+  if (config.shuffle) {
+    state.pack.shuffle();
+  } else {
+    state.pack.reset();
+  }
+
+  // Public history of this hand, shared with every player
+  Info_set &info = state.info;
+  for (int i = 0; i < 4; ++i) players[i]->watch(info);
+
+  Referee referee(config.referee, hr, obs);
+  deal_hand(state.pack, players, hr.dealer, referee);
+  obs.hands_dealt(referee.dealt());
+
+  hr.upcard = state.pack.deal_one();
+  info.begin_hand(hr.dealer, hr.upcard);
+  obs.upcard(hr.upcard);
+
+  // Make trump phases
+  bool thrown_in = false;
+  const bool ordered_up = try_round_one(players, hr, obs, info);
+  if (!ordered_up && !try_round_two<R>(players, hr, obs, info)) {
+    if constexpr (R::stick_the_dealer) {
+      screw_the_dealer(hr, obs, info);
+    } else {
+      thrown_in = true;
+    }
+  }
+  if constexpr (R::going_alone) {
+    if (!thrown_in) choose_alone<R>(players, hr, obs, info);
+  }
+  // Dealer picks up & discards on round 1 if anyone orders up and it plays
+  if (ordered_up && !info.sits_out(hr.dealer)) {
+    players[hr.dealer]->add_and_discard(hr.upcard);
+    referee.pick_up(hr.dealer);
+  }
+  obs.bidding_end();
+
+  if (thrown_in) {
+    hr.thrown_in = true;
+    for (int i = 0; i < 4; ++i) players[i]->clear_hand();
+  } else {
+    // Play five tricks, led by the first player left of the dealer
+    int leader = (hr.dealer + 1) % 4;
+    if constexpr (R::going_alone) {
+      while (info.sits_out(leader)) leader = (leader + 1) % 4;
+    }
+    for (int trick = 0; trick < 5; ++trick) {
+      leader = play_trick<R>(players, leader, referee, info);
+      ++hr.tricks[leader % 2];
+      obs.trick_won(leader);
+    }
+    if constexpr (R::going_alone) {
+      for (int i = 0; i < 4; ++i) {
+        if (info.sits_out(i)) players[i]->clear_hand();
+      }
+    }
+    score_hand<R>(hr, state);
+  }
+  obs.hand_end(hr, state);
+
+  state.dealer = (state.dealer + 1) % 4;
+  ++state.hand;
+  return hr;
+}
+
+// Forkable hands
+
+// Seats playing, counted from the leader: 4, 3 if a maker goes alone, or 2
+// if a defender also defends alone
+static int seats_playing(const Info_set &info) {
+  int n = 0;
+  for (int seat = 0; seat < 4; ++seat) n += !info.sits_out(seat);
+  return n;
+}
+
+// Next seat after seat that plays this hand
+static int next_playing(const Info_set &info, int seat) {
+  do {
+    seat = (seat + 1) % 4;
+  } while (info.sits_out(seat));
+  return seat;
+}
+
+// A full trick stays in the Info_set until the next card is led
+static bool leading(const Hand_state &s) {
+  int n = s.info.trick_size();
+  return n == 0 || n == seats_playing(s.info);
+}
+
+Hand_state start_play(const Info_set &info, const Card_set hands[]) {
+  Hand_state s;
+  s.info = info;
+  for (int seat = 0; seat < 4; ++seat) s.hands[seat] = hands[seat];
+  s.to_play = next_playing(info, info.get_dealer());
+  return s;
+}
+
+bool hand_over(const Hand_state &s) {
+  return s.tricks[0] + s.tricks[1] == 5;
+}
+
+Card_set legal_cards(const Hand_state &s) {
+  Card_set hand = s.hands[s.to_play];
+  if (leading(s)) return hand;
+  return legal_plays(hand, s.info.trick_card(0), s.info.get_trump());
+}
+
+void apply_play(Hand_state &s, const Card &c) {
+  assert(legal_cards(s) & card_bit(c));
+  s.info.play(s.to_play, c);
+  s.hands[s.to_play] &= ~card_bit(c);
+  int n = s.info.trick_size();
+  if (n < seats_playing(s.info)) {
+    s.to_play = next_playing(s.info, s.to_play);
+    return;
+  }
+  Card cards[4];
+  for (int i = 0; i < n; ++i) cards[i] = s.info.trick_card(i);
+  int winner = s.info.trick_leader();
+  for (int i = trick_winner(cards, n, s.info.get_trump()); i > 0; --i) {
+    winner = next_playing(s.info, winner);
+  }
+  ++s.tricks[winner % 2];
+  s.to_play = winner;
+}
+
+void play_out(Hand_state &s, Player *const players[]) {
+  for (int i = 0; i < 4; ++i) players[i]->watch(s.info);
+  const Suit trump = s.info.get_trump();
+  while (!hand_over(s)) {
+    Player *p = players[s.to_play];
+    Card c = leading(s) ? p->lead_card(trump)
+                        : p->play_card(s.info.trick_card(0), trump);
+    if (!(legal_cards(s) & card_bit(c))) throw Illegal_play(s.to_play, c);
+    apply_play(s, c);
+  }
+}
+
+bool game_over(const Game_state &state, const Game_config &config) {
+  return state.score[0] >= config.points_to_win ||
+         state.score[1] >= config.points_to_win;
+}
+
+template <class R>
+int play_game(Game_state &state, Player *const players[],
+              const Game_config &config, Game_observer &obs) {
+  assert(config.points_to_win <= R::max_points_to_win);
+  while (!game_over(state, config)) {
+    play_hand<R>(state, players, config, obs);
+  }
+  int winner = (state.score[0] >= config.points_to_win) ? 0 : 1;
+  obs.game_end(winner);
+  return winner;
+}
+
+Hand_result play_hand(Game_state &state, Player *const players[],
+                      const Game_config &config, Game_observer &obs) {
+  return play_hand<Standard_rules>(state, players, config, obs);
+}
+
+int play_game(Game_state &state, Player *const players[],
+              const Game_config &config, Game_observer &obs) {
+  return play_game<Standard_rules>(state, players, config, obs);
+}
+
+// One engine per rule combination
+#define INSTANTIATE_RULES(STICK, ALONE, DEFEND, LONG)                        \
+  template Hand_result play_hand<Rules<STICK, ALONE, DEFEND, LONG>>(         \
+    Game_state &, Player *const[], const Game_config &, Game_observer &);    \
+  template int play_game<Rules<STICK, ALONE, DEFEND, LONG>>(                 \
+    Game_state &, Player *const[], const Game_config &, Game_observer &)
+
+INSTANTIATE_RULES(true, false, false, false);
+INSTANTIATE_RULES(true, false, false, true);
+INSTANTIATE_RULES(true, true, false, false);
+INSTANTIATE_RULES(true, true, false, true);
+INSTANTIATE_RULES(true, true, true, false);
+INSTANTIATE_RULES(true, true, true, true);
+INSTANTIATE_RULES(false, false, false, false);
+INSTANTIATE_RULES(false, false, false, true);
+INSTANTIATE_RULES(false, true, false, false);
+INSTANTIATE_RULES(false, true, false, true);
+INSTANTIATE_RULES(false, true, true, false);
+INSTANTIATE_RULES(false, true, true, true);
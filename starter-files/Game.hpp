@@ -0,0 +1,221 @@
+#ifndef GAME_HPP
+#define GAME_HPP
+/* Game.hpp
+ *
+ * Euchre game engine: dealing, making trump, playing tricks and scoring.
+ *
+ * Seats are numbered 0-3 in playing order.  Seats 0 and 2 form team 0 and
+ * seats 1 and 3 form team 1.  The engine prints nothing itself; everything
+ * that happens is reported to a Game_observer.
+ */
+
+#include "Card.hpp"
+#include "Info_set.hpp"
+#include "Pack.hpp"
+#include "Player.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// What the referee does when a player leads or plays a card it may not:
+// one it does not hold, or one off the led suit while it can follow.
+enum Referee_policy {
+  REFEREE_ABORT,     // throw Illegal_play
+  REFEREE_REPROMPT,  // hand the card back and ask again, then abort
+  REFEREE_PENALTY,   // let the play stand; the other team scores 2 points
+};
+
+// Rule variants, fixed at compile time so that every combination gets its
+// own engine with no rule checks left in the loop:
+//   Stick_the_dealer  the dealer must name trump in round 2; without it a
+//                     hand that nobody orders up is thrown in
+//   Going_alone       the maker may play without its partner; a lone march
+//                     scores 4
+//   Defend_alone      against a lone maker, one defender may play without
+//                     its partner; a lone euchre scores 4
+//   Long_games        points_to_win may be more than 100
+template <bool Stick_the_dealer, bool Going_alone, bool Defend_alone,
+          bool Long_games>
+struct Rules {
+  static_assert(Going_alone || !Defend_alone,
+                "defending alone needs going alone");
+  static constexpr bool stick_the_dealer = Stick_the_dealer;
+  static constexpr bool going_alone = Going_alone;
+  static constexpr bool defend_alone = Defend_alone;
+  static constexpr int max_points_to_win = Long_games ? 1000000 : 100;
+};
+
+// The rules of the EECS 280 spec and of euchre.exe
+using Standard_rules = Rules<true, false, false, false>;
+
+// Rules that stay fixed for a whole game
+struct Game_config {
+  bool shuffle = false;   // in-shuffle the pack before every hand
+  int points_to_win = 10;
+  Referee_policy referee = REFEREE_ABORT;
+};
+
+// Everything that carries over from one hand to the next
+struct Game_state {
+  Pack pack;
+  int hand = 0;           // index of the next hand
+  int dealer = 0;         // seat of the next dealer
+  int score[2] = {0, 0};  // points per team
+  Info_set info;          // public history of the current or last hand
+};
+
+// Outcome of one hand
+struct Hand_result {
+  Card upcard;
+  int dealer = 0;
+  int maker = 0;           // seat that ordered up trump
+  int round = 0;           // 1 or 2, or 3 if the dealer was stuck with trump
+  Suit trump = SPADES;
+  int tricks[2] = {0, 0};  // tricks taken per team
+  int points[2] = {0, 0};  // points awarded per team
+  bool march = false;
+  bool euchred = false;
+  int reneges[2] = {0, 0}; // illegal plays per team, under REFEREE_PENALTY
+  int alone = -1;          // seat of a maker going alone, or -1
+  int defending_alone = -1;
+  bool thrown_in = false;  // nobody ordered up and the dealer was not stuck
+};
+
+// Thrown by the engine when the referee stops a game
+class Illegal_play : public std::runtime_error {
+public:
+  Illegal_play(int seat_in, const Card &card_in);
+
+  int seat;
+  Card card;
+};
+
+// Receives the events of a game in the order they happen.  Every callback
+// does nothing by default, so observers override only what they need.
+class Game_observer {
+public:
+  virtual void hand_begin(int hand, int dealer) {}
+  // The five cards each seat was dealt, indexed by seat; not in transcripts
+  virtual void hands_dealt(const Card_set hands[]) {}
+  virtual void upcard(const Card &upcard) {}
+  virtual void pass(int seat) {}
+  virtual void order_up(int seat, Suit trump) {}
+  virtual void going_alone(int seat) {}
+  virtual void defending_alone(int seat) {}
+  virtual void bidding_end() {}
+  virtual void card_led(int seat, const Card &card) {}
+  virtual void card_played(int seat, const Card &card) {}
+  virtual void illegal_play(int seat, const Card &card) {}
+  virtual void trick_won(int seat) {}
+  virtual void hand_end(const Hand_result &result, const Game_state &state) {}
+  virtual void game_end(int team) {}
+
+  virtual ~Game_observer() {}
+};
+
+// Prints the standard euchre.exe transcript of a game.
+class Transcript : public Game_observer {
+public:
+  //REQUIRES players holds four players that outlive the Transcript
+  Transcript(std::ostream &os_in, Player *const players_in[]);
+
+  void hand_begin(int hand, int dealer) override;
+  void upcard(const Card &upcard) override;
+  void pass(int seat) override;
+  void order_up(int seat, Suit trump) override;
+  void going_alone(int seat) override;
+  void defending_alone(int seat) override;
+  void bidding_end() override;
+  void card_led(int seat, const Card &card) override;
+  void card_played(int seat, const Card &card) override;
+  void illegal_play(int seat, const Card &card) override;
+  void trick_won(int seat) override;
+  void hand_end(const Hand_result &result, const Game_state &state) override;
+  void game_end(int team) override;
+
+private:
+  std::ostream &os;
+  Player *const *players;
+  std::string team_names[2];
+};
+
+//EFFECTS Returns the position (0-3) in cards of the card that wins a trick
+//  in which cards[0] was led and cards[1..3] followed.
+int trick_winner(const Card cards[], Suit trump);
+
+//REQUIRES players holds four players with empty hands
+//MODIFIES state, players, obs
+//EFFECTS Plays one hand: shuffles or resets the pack, deals, makes trump,
+//  plays five tricks and scores them.  Advances state to the next hand.
+//  Every card played is checked by a referee that follows config.referee;
+//  throws Illegal_play if it aborts the game.
+Hand_result play_hand(Game_state &state, Player *const players[],
+                      const Game_config &config, Game_observer &obs);
+
+//EFFECTS Returns true if either team has enough points to win
+bool game_over(const Game_state &state, const Game_config &config);
+
+//REQUIRES players holds four players with empty hands
+//MODIFIES state, players, obs
+//EFFECTS Plays hands until a team reaches config.points_to_win and returns
+//  that team.
+int play_game(Game_state &state, Player *const players[],
+              const Game_config &config, Game_observer &obs);
+
+//REQUIRES R is a Rules<...>, players holds four players with empty hands
+//  and config.points_to_win <= R::max_points_to_win
+//MODIFIES state, players, obs
+//EFFECTS play_hand and play_game under the rule variants R.  A player
+//  that sits out, or whose hand is thrown in, is told to discard its hand
+//  with Player::clear_hand, which is not reported.
+template <class R>
+Hand_result play_hand(Game_state &state, Player *const players[],
+                      const Game_config &config, Game_observer &obs);
+template <class R>
+int play_game(Game_state &state, Player *const players[],
+              const Game_config &config, Game_observer &obs);
+
+// The play of a hand after trump is made, as a plain value: forking a hand
+// at any card is a copy of a Hand_state and a Player::clone() of each
+// player.  The dealer's discard is not public, so the hands come from
+// whoever knows them, for example a search that deals out the unseen cards.
+struct Hand_state {
+  Info_set info;                    // trump, who sits out, the trick so far
+  Card_set hands[4] = {0, 0, 0, 0}; // cards each seat still holds
+  int to_play = 0;                  // seat to lead or play next
+  int tricks[2] = {0, 0};           // tricks taken per team
+};
+
+//REQUIRES info.trump_made() and no card has been played; hands holds what
+//  each seat playing was left with after bidding
+//EFFECTS Returns the hand before the first lead, by the first seat left of
+//  the dealer that plays
+Hand_state start_play(const Info_set &info, const Card_set hands[]);
+
+//EFFECTS Returns true if all five tricks have been played
+bool hand_over(const Hand_state &s);
+
+//REQUIRES !hand_over(s)
+//EFFECTS Returns the cards s.to_play may lead or play
+Card_set legal_cards(const Hand_state &s);
+
+//REQUIRES c is in legal_cards(s)
+//MODIFIES s
+//EFFECTS Plays c for s.to_play.  When that completes a trick, the winner
+//  takes it and leads next.
+void apply_play(Hand_state &s, const Card &c);
+
+//REQUIRES players holds four players, each holding exactly its cards in s
+//  (seats that sit out need hold nothing)
+//MODIFIES s, players
+//EFFECTS Points every player at s.info and asks them for cards until the
+//  hand is over.  Nothing is reported and nothing scored; throws
+//  Illegal_play for a card a player may not play.
+void play_out(Hand_state &s, Player *const players[]);
+
+static_assert(std::is_trivially_copyable<Hand_state>::value &&
+              std::is_trivially_copyable<Game_state>::value,
+              "forking a game or a hand must be a plain copy");
+
+#endif // GAME_HPP
@@ -0,0 +1,60 @@
+// Game_spec.cpp
+#include "Game_spec.hpp"
+
+using namespace std;
+
+// Returns true if t is valid player type
+static bool is_player_type(const string &t) {
+  return t == "Simple" || t == "Human" || t == "Scripted" || t == "Neural";
+}
+
+bool parse_game_spec(const vector<string> &args, Game_spec &spec) {
+  if (args.size() != 11) return false;
+  spec.pack_filename = args[0];
+
+  if (args[1] == "shuffle") {
+    spec.config.shuffle = true;
+  } else if (args[1] == "noshuffle") {
+    spec.config.shuffle = false;
+  } else {
+    return false;
+  }
+
+  try {
+    spec.config.points_to_win = stoi(args[2]);
+  } catch (...) {
+    return false;
+  }
+  if (spec.config.points_to_win < 1 || spec.config.points_to_win > 100) {
+    return false;
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    spec.names[i] = args[3 + 2 * i];
+    spec.types[i] = args[4 + 2 * i];
+    if (!is_player_type(spec.types[i])) return false;
+  }
+  return true;
+}
+
+int play_game_spec(const Game_spec &spec, Game_state &state,
+                   Player *const players[], ostream &os) {
+  Transcript transcript(os, players);
+  Game_observer quiet;
+  try {
+    play_game(state, players, spec.config, spec.summary ? quiet : transcript);
+  } catch (const runtime_error &e) {   // an Illegal_play or a bad script
+    os << "Error: " << e.what() << '\n';
+    return 1;
+  }
+  if (spec.summary) print_game_summary(os, spec, state);
+  return 0;
+}
+
+void print_game_summary(ostream &os, const Game_spec &spec,
+                        const Game_state &state) {
+  int winner = state.score[0] >= spec.config.points_to_win ? 0 : 1;
+  os << spec.names[winner] << " and " << spec.names[winner + 2]
+     << " win " << state.score[winner] << " to "
+     << state.score[1 - winner] << " after " << state.hand << " hands\n";
+}
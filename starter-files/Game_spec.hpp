@@ -0,0 +1,44 @@
+#ifndef GAME_SPEC_HPP
+#define GAME_SPEC_HPP
+/* Game_spec.hpp
+ *
+ * One game as euchre.exe takes it on the command line: a pack file, shuffle
+ * or noshuffle, points to win, and four names and player types.  Shared by
+ * euchre.exe, its daemon mode and the batch runner.
+ */
+
+#include "Game.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Game_spec {
+  std::string pack_filename;
+  Game_config config;
+  std::string names[4];
+  std::string types[4];
+  bool summary = false;   // print one line for the game, not its transcript
+};
+
+//MODIFIES spec
+//EFFECTS Parses the arguments after the program name into spec.  Returns
+//  false if they are not a valid game; the usage message is left to the
+//  caller.
+bool parse_game_spec(const std::vector<std::string> &args, Game_spec &spec);
+
+//REQUIRES state starts from the pack of spec and players are seated in
+//  the order of spec
+//MODIFIES state, players, os
+//EFFECTS Plays the game, writing its transcript to os, or with
+//  spec.summary a line like "Adi and Chi-Chih win 10 to 7 after 12 hands".
+//  If a player breaks a rule, writes "Error: ..." and returns 1; otherwise
+//  returns 0.
+int play_game_spec(const Game_spec &spec, Game_state &state,
+                   Player *const players[], std::ostream &os);
+
+//REQUIRES the game of spec has been played to the end in state
+//EFFECTS Prints the summary line of the game to os
+void print_game_summary(std::ostream &os, const Game_spec &spec,
+                        const Game_state &state);
+
+#endif // GAME_SPEC_HPP
@@ -0,0 +1,491 @@
+// Game Tests
+#include "Game.hpp"
+#include "Hand_stats.hpp"
+#include "unit_test_framework.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Every heap allocation in this program goes through one of these.  Only
+// allocations made on a thread that is counting are counted, since with -j
+// other tests run at the same time.  Array forms, sized deletes and nothrow
+// deletes forward to these by default.
+static atomic<size_t> allocations(0);
+static thread_local bool counting = false;
+
+static void * allocate(size_t size, size_t alignment) {
+    if (counting) ++allocations;
+    size = size ? size : 1;
+    if (alignment <= alignof(max_align_t)) return malloc(size);
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void * operator new(size_t size) {
+    if (void *p = allocate(size, 1)) return p;
+    throw bad_alloc();
+}
+
+void * operator new(size_t size, const nothrow_t &) noexcept {
+    return allocate(size, 1);
+}
+
+void * operator new(size_t size, align_val_t alignment) {
+    if (void *p = allocate(size, static_cast<size_t>(alignment))) return p;
+    throw bad_alloc();
+}
+
+void * operator new(size_t size, align_val_t alignment,
+                    const nothrow_t &) noexcept {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, align_val_t) noexcept { free(p); }
+
+// Counts the allocations of this thread while in scope
+class Counting {
+public:
+    Counting() { counting = true; }
+    ~Counting() { counting = false; }
+};
+
+// Four Simple players for the standard pack (pack.in order)
+class Table {
+public:
+    Table() {
+        const char *const names[] = {"Adi", "Barbara", "Chi-Chih", "Dabbala"};
+        for (int i = 0; i < 4; ++i) players[i] = Player_factory(names[i], "Simple");
+    }
+    ~Table() {
+        for (Player *p : players) delete p;
+    }
+    Player *players[4];
+};
+
+// Always plays the card it was dealt first, following suit or not
+class Cheater : public Player {
+public:
+    const std::string & get_name() const override { return name; }
+    void add_card(const Card &c) override {
+        hand.insert(hand.begin(), c);
+        ++cards_added;
+    }
+    bool make_trump(const Card &, bool, int, Suit &) const override {
+        return false;
+    }
+    void add_and_discard(const Card &upcard) override { hand.back() = upcard; }
+    Card lead_card(Suit) override { return play_card(Card(), SPADES); }
+    Card play_card(const Card &, Suit) override {
+        ++plays;
+        Card c = hand.back();
+        hand.pop_back();
+        return c;
+    }
+    void clear_hand() override { hand.clear(); }
+
+    std::string name = "Cheater";
+    std::vector<Card> hand;
+    int cards_added = 0;
+    int plays = 0;
+};
+
+// Plays hands of a cheater in seat 0 against three Simple players until
+// one has a renege or max_hands have been played.  Returns that hand.
+static Hand_result play_until_renege(Cheater &cheater, const Game_config &config,
+                                     Game_state &state, int max_hands) {
+    // The cheater replaces Adi, and is not deleted with the table
+    Table table;
+    delete table.players[0];
+    table.players[0] = &cheater;
+    struct Release {
+        ~Release() { seat0 = Player_factory("Adi", "Simple"); }
+        Player *&seat0;
+    } release{table.players[0]};
+    Game_observer quiet;
+    Hand_result hr;
+    for (int i = 0; i < max_hands && hr.reneges[0] == 0; ++i) {
+        hr = play_hand(state, table.players, config, quiet);
+        cheater.hand.clear();
+    }
+    return hr;
+}
+
+TEST(test_trick_winner_highest_of_led_suit) {
+    Card cards[] = {Card(TEN, SPADES), Card(ACE, SPADES),
+                    Card(ACE, HEARTS), Card(KING, SPADES)};
+    ASSERT_EQUAL(trick_winner(cards, CLUBS), 1);
+}
+
+TEST(test_trick_winner_trump_and_left_bower) {
+    Card cards[] = {Card(ACE, SPADES), Card(NINE, HEARTS),
+                    Card(JACK, DIAMONDS), Card(ACE, HEARTS)};
+    ASSERT_EQUAL(trick_winner(cards, HEARTS), 2);
+}
+
+TEST(test_play_hand_first_hand_of_test00) {
+    Table table;
+    Game_state state;
+    Game_config config;
+    Game_observer quiet;
+    Hand_result hr = play_hand(state, table.players, config, quiet);
+
+    ASSERT_EQUAL(hr.upcard, Card(JACK, DIAMONDS));
+    ASSERT_EQUAL(hr.maker, 1);
+    ASSERT_EQUAL(hr.round, 2);
+    ASSERT_EQUAL(hr.trump, HEARTS);
+    ASSERT_EQUAL(hr.tricks[0] + hr.tricks[1], 5);
+    ASSERT_EQUAL(state.score[0], hr.points[0]);
+    ASSERT_EQUAL(state.score[1], hr.points[1]);
+    ASSERT_EQUAL(state.hand, 1);
+    ASSERT_EQUAL(state.dealer, 1);
+}
+
+TEST(test_play_game_stops_at_points_to_win) {
+    Table table;
+    Game_state state;
+    Game_config config;
+    config.points_to_win = 3;
+    Game_observer quiet;
+    int winner = play_game(state, table.players, config, quiet);
+
+    ASSERT_TRUE(state.score[winner] >= 3);
+    ASSERT_TRUE(state.score[1 - winner] < 3);
+    ASSERT_TRUE(game_over(state, config));
+}
+
+TEST(test_transcript_hand_header) {
+    Table table;
+    ostringstream oss;
+    Transcript transcript(oss, table.players);
+    transcript.hand_begin(0, 0);
+    transcript.upcard(Card(JACK, DIAMONDS));
+    ASSERT_EQUAL(oss.str(), "Hand 0\nAdi deals\nJack of Diamonds turned up\n");
+}
+
+TEST(test_referee_penalty_gives_two_points_per_renege) {
+    Cheater cheater;
+    Game_state state;
+    Game_config config;
+    config.referee = REFEREE_PENALTY;
+    Hand_result hr = play_until_renege(cheater, config, state, 20);
+    ASSERT_TRUE(hr.reneges[0] > 0);
+    ASSERT_EQUAL(hr.reneges[1], 0);
+    ASSERT_TRUE(hr.points[1] >= 2 * hr.reneges[0]);
+}
+
+TEST(test_referee_abort_throws) {
+    Cheater cheater;
+    Game_state state;
+    Game_config config;
+    bool thrown = false;
+    try {
+        play_until_renege(cheater, config, state, 20);
+    } catch (const Illegal_play &e) {
+        thrown = true;
+        ASSERT_EQUAL(e.seat, 0);
+    }
+    ASSERT_TRUE(thrown);
+}
+
+TEST(test_referee_reprompt_hands_card_back) {
+    Cheater cheater;
+    Game_state state;
+    Game_config config;
+    config.referee = REFEREE_REPROMPT;
+    Hand_result hr = play_until_renege(cheater, config, state, 20);
+    // Rejected cards go back to the front of the cheater's hand, so it tries
+    // another card and every hand ends legally
+    ASSERT_EQUAL(hr.reneges[0], 0);
+    ASSERT_EQUAL(state.hand, 20);
+    ASSERT_TRUE(cheater.cards_added > 5 * state.hand);
+    ASSERT_TRUE(cheater.plays > 5 * state.hand);
+}
+
+// A Simple player that keeps the Info_set it is given
+class Watcher : public Player {
+public:
+    Watcher() : simple(Player_factory("Watcher", "Simple")) {}
+    ~Watcher() { delete simple; }
+    const std::string & get_name() const override { return simple->get_name(); }
+    void add_card(const Card &c) override { simple->add_card(c); }
+    bool make_trump(const Card &upcard, bool is_dealer, int round,
+                    Suit &suit) const override {
+        return simple->make_trump(upcard, is_dealer, round, suit);
+    }
+    void add_and_discard(const Card &upcard) override {
+        ++pick_ups;
+        simple->add_and_discard(upcard);
+    }
+    Card lead_card(Suit trump) override { return simple->lead_card(trump); }
+    Card play_card(const Card &led_card, Suit trump) override {
+        ASSERT_EQUAL(info->trick_card(0), led_card);
+        return simple->play_card(led_card, trump);
+    }
+    void clear_hand() override { simple->clear_hand(); }
+    void watch(const Info_set &info_in) override { info = &info_in; }
+
+    Player *simple;
+    const Info_set *info = nullptr;
+    int pick_ups = 0;
+};
+
+// A Watcher that always goes alone and always defends alone
+class Bold : public Watcher {
+public:
+    bool go_alone(Suit) const override { return true; }
+    bool defend_alone(Suit) const override { return true; }
+};
+
+// Four Bold players, deleted with the table
+class Bold_table {
+public:
+    Bold_table() {
+        for (Player *&p : players) p = new Bold;
+    }
+    ~Bold_table() {
+        for (Player *p : players) delete p;
+    }
+    Player *players[4];
+};
+
+TEST(test_info_set_records_first_hand_of_test00) {
+    Table table;
+    delete table.players[1];
+    Watcher *watcher = new Watcher;
+    table.players[1] = watcher;
+    Game_state state;
+    Game_config config;
+    Game_observer quiet;
+    Hand_result hr = play_hand(state, table.players, config, quiet);
+
+    const Info_set &info = *watcher->info;
+    ASSERT_EQUAL(info.get_upcard(), hr.upcard);
+    ASSERT_EQUAL(info.get_maker(), hr.maker);
+    ASSERT_EQUAL(info.get_trump(), hr.trump);
+    ASSERT_FALSE(info.upcard_picked_up());
+    ASSERT_EQUAL(info.trick_size(), 4);
+    Card_set all = 0;
+    for (int seat = 0; seat < 4; ++seat) {
+        ASSERT_EQUAL(__builtin_popcountll(info.played(seat)), 5);
+        ASSERT_EQUAL(all & info.played(seat), Card_set(0));
+        all |= info.played(seat);
+        // A void seat played nothing of that suit after showing it
+        for (int s = SPADES; s <= DIAMONDS; ++s) {
+            Suit suit = static_cast<Suit>(s);
+            if (!info.is_void(seat, suit)) continue;
+            ASSERT_TRUE((info.played(seat) & suit_cards(suit, hr.trump)) !=
+                        info.played(seat));
+        }
+    }
+    ASSERT_EQUAL(info.played(), all);
+}
+
+TEST(test_rules_without_stick_the_dealer_throw_hands_in) {
+    using No_stick = Rules<false, false, false, false>;
+    // Cheaters always pass
+    Cheater cheaters[4];
+    Player *players[4] = {&cheaters[0], &cheaters[1], &cheaters[2], &cheaters[3]};
+    Game_state state;
+    Game_config config;
+    Game_observer quiet;
+    Hand_result hr = play_hand<No_stick>(state, players, config, quiet);
+    ASSERT_TRUE(hr.thrown_in);
+    ASSERT_EQUAL(hr.points[0] + hr.points[1], 0);
+    ASSERT_EQUAL(hr.tricks[0] + hr.tricks[1], 0);
+    ASSERT_EQUAL(state.dealer, 1);
+    // Hands were laid down, ready for the next deal
+    for (const Cheater &c : cheaters) ASSERT_TRUE(c.hand.empty());
+}
+
+TEST(test_rules_going_alone_partner_sits_out) {
+    using Loners = Rules<true, true, false, false>;
+    Bold_table table;
+    Game_state state;
+    Game_config config;
+    Game_observer quiet;
+    Rng rng(1);
+    bool lone_march = false;
+    for (int i = 0; i < 1000 && !lone_march; ++i) {
+        state.pack.shuffle(rng);
+        const int dealer = state.dealer;
+        Watcher *dealer_player = static_cast<Watcher *>(table.players[dealer]);
+        const int pick_ups = dealer_player->pick_ups;
+        Hand_result hr = play_hand<Loners>(state, table.players, config, quiet);
+        ASSERT_EQUAL(hr.alone, hr.maker);
+        ASSERT_EQUAL(hr.defending_alone, -1);
+        ASSERT_EQUAL(state.info.played((hr.maker + 2) % 4), Card_set(0));
+        // A dealer sitting out leaves the upcard where it is
+        const bool dealer_out = (hr.maker + 2) % 4 == dealer;
+        ASSERT_EQUAL(dealer_player->pick_ups - pick_ups,
+                     hr.round == 1 && !dealer_out ? 1 : 0);
+        ASSERT_EQUAL(state.info.upcard_picked_up(),
+                     hr.round == 1 && !dealer_out);
+        ASSERT_EQUAL(hr.tricks[0] + hr.tricks[1], 5);
+        if (hr.march) {
+            lone_march = true;
+            ASSERT_EQUAL(hr.points[hr.maker % 2], 4);
+        }
+    }
+    ASSERT_TRUE(lone_march);
+}
+
+TEST(test_rules_defending_alone_euchre_scores_four) {
+    using Duels = Rules<true, true, true, true>;
+    Bold_table table;
+    Game_state state;
+    Game_config config;
+    config.points_to_win = 500;
+    Game_observer quiet;
+    Rng rng(1);
+    bool lone_euchre = false;
+    for (int i = 0; i < 1000 && !lone_euchre; ++i) {
+        state.pack.shuffle(rng);
+        Hand_result hr = play_hand<Duels>(state, table.players, config, quiet);
+        ASSERT_EQUAL(hr.defending_alone, (hr.maker + 1) % 4);
+        if (hr.euchred) {
+            lone_euchre = true;
+            ASSERT_EQUAL(hr.points[1 - hr.maker % 2], 4);
+        }
+    }
+    ASSERT_TRUE(lone_euchre);
+}
+
+// Plays n games of four Simple players the way simulate.exe does, with a
+// fresh random deal before every hand
+static void play_random_games(Player *const players[], Rng &rng, int n) {
+    Game_config config;
+    Game_observer quiet;
+    for (int i = 0; i < n; ++i) {
+        Game_state state;
+        while (!game_over(state, config)) {
+            state.pack.shuffle(rng);
+            play_hand(state, players, config, quiet);
+        }
+    }
+}
+
+TEST(test_steady_state_games_do_not_allocate) {
+    Table table;
+    Rng rng(280);
+    play_random_games(table.players, rng, 100);  // warm up
+    Counting on;
+    size_t before = allocations;
+    // Calls, so they are never elided: the hooks are in place
+    operator delete(operator new(1));
+    operator delete(operator new(1, nothrow));
+    operator delete(operator new(1, align_val_t(64)), align_val_t(64));
+    ASSERT_EQUAL(allocations - before, size_t(3));
+    before = allocations;
+    play_random_games(table.players, rng, 10000);
+    ASSERT_EQUAL(allocations - before, size_t(0));
+}
+
+TEST(test_hand_stats_merged_halves_match_one_pass) {
+    Table table;
+    Rng rng(42);
+    Game_config config;
+    Game_observer quiet;
+    Hand_stats whole, halves[2];
+    Game_state state;
+    for (int i = 0; i < 1000; ++i) {
+        state.pack.shuffle(rng);
+        Hand_result hr = play_hand(state, table.players, config, quiet);
+        whole.add(hr);
+        halves[i % 2].add(hr);
+    }
+    halves[0].merge(halves[1]);
+    ASSERT_EQUAL(whole.hands(), uint64_t(1000));
+    ostringstream a, b;
+    whole.print(a);
+    halves[0].print(b);
+    ASSERT_EQUAL(a.str(), b.str());
+    ASSERT_TRUE(a.str().find("left of dealer") != string::npos);
+}
+
+// Deals five random cards to each seat playing, with hearts trump made by
+// seat 1, who goes alone in odd hands
+static Hand_state deal_forkable_hand(Player *const players[], Rng &rng,
+                                     int i) {
+    Pack pack;
+    pack.shuffle(rng);
+    Info_set info;
+    info.begin_hand(0, pack.deal_one());
+    info.make_trump(1, HEARTS, false);
+    if (i % 2) info.sit_out(3);
+    Card_set hands[4] = {0, 0, 0, 0};
+    for (int seat = 0; seat < 4; ++seat) {
+        for (int j = 0; j < Player::MAX_HAND_SIZE && !info.sits_out(seat); ++j) {
+            Card c = pack.deal_one();
+            players[seat]->add_card(c);
+            hands[seat] |= card_bit(c);
+        }
+    }
+    return start_play(info, hands);
+}
+
+TEST(test_forked_hands_play_out_like_the_original) {
+    Rng rng(44);
+    for (int i = 0; i < 200; ++i) {
+        Table table;
+        Hand_state s = deal_forkable_hand(table.players, rng, i);
+
+        // Some cards in, play the lowest legal card for whoever is to play
+        for (int k = 0; k < i % 12; ++k) {
+            Card_set legal = legal_cards(s);
+            int bit = __builtin_ctzll(legal);
+            Card c(static_cast<Rank>(bit / 4), static_cast<Suit>(bit % 4));
+            table.players[s.to_play]->drop_card(c);
+            apply_play(s, c);
+        }
+
+        // The same fork plays out the same way
+        Hand_state fork = s;
+        Player *clones[4];
+        for (int seat = 0; seat < 4; ++seat) {
+            clones[seat] = table.players[seat]->clone();
+        }
+        play_out(s, table.players);
+        play_out(fork, clones);
+        ASSERT_EQUAL(s.tricks[0] + s.tricks[1], 5);
+        ASSERT_EQUAL(fork.tricks[0], s.tricks[0]);
+        for (int seat = 0; seat < 4; ++seat) {
+            ASSERT_EQUAL(fork.info.played(seat), s.info.played(seat));
+            ASSERT_EQUAL(fork.hands[seat], Card_set(0));
+            delete clones[seat];
+        }
+    }
+}
+
+TEST(test_forks_try_every_legal_card) {
+    Rng rng(45);
+    Table table;
+    Hand_state s = deal_forkable_hand(table.players, rng, 1);
+    Card_set legal = legal_cards(s);
+    for (int bit = 0; bit < 64; ++bit) {
+        if (!(legal >> bit & 1)) continue;
+        Card c(static_cast<Rank>(bit / 4), static_cast<Suit>(bit % 4));
+        Hand_state fork = s;
+        Player *clones[4];
+        for (int seat = 0; seat < 4; ++seat) {
+            clones[seat] = table.players[seat]->clone();
+        }
+        clones[fork.to_play]->drop_card(c);
+        apply_play(fork, c);
+        play_out(fork, clones);
+        ASSERT_EQUAL(fork.tricks[0] + fork.tricks[1], 5);
+        ASSERT_TRUE(fork.info.played(s.to_play) & card_bit(c));
+        for (Player *p : clones) delete p;
+    }
+    ASSERT_EQUAL(s.tricks[0] + s.tricks[1], 0);  // the original is untouched
+}
+
+TEST_MAIN()
@@ -0,0 +1,94 @@
+// Hand_stats.cpp
+#include "Hand_stats.hpp"
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+void Hand_stats::merge(const Hand_stats &other) {
+  for (int i = 0; i < NUM_COUNTS; ++i) counts[i] += other.counts[i];
+}
+
+uint64_t Hand_stats::hands() const {
+  uint64_t n = counts[CELLS * NUM_OUTCOMES];
+  for (int cell = 0; cell < CELLS; ++cell) {
+    n += counts[cell * NUM_OUTCOMES + HANDS];
+  }
+  return n;
+}
+
+static string rank_label(int row) {
+  ostringstream os;
+  os << static_cast<Rank>(NINE + row);
+  return os.str();
+}
+
+static string suit_label(int row) {
+  ostringstream os;
+  os << static_cast<Suit>(row);
+  return os.str();
+}
+
+static string seat_label(int row) {
+  static const char *const SEATS[] = {
+    "dealer", "left of dealer", "partner", "right of dealer"
+  };
+  return SEATS[row];
+}
+
+static string round_label(int row) {
+  static const char *const ROUNDS[] = {"round 1", "round 2", "stuck dealer"};
+  return ROUNDS[row];
+}
+
+// One way of splitting the cells: a cell's row is (cell / stride) % rows
+struct Breakdown {
+  const char *title;
+  int stride;
+  int rows;
+  string (*label)(int row);
+};
+
+static double percent(uint64_t part, uint64_t whole) {
+  return whole ? 100.0 * static_cast<double>(part) /
+                 static_cast<double>(whole) : 0;
+}
+
+void Hand_stats::print(ostream &os) const {
+  const Breakdown BREAKDOWNS[] = {
+    {"upcard", ROUNDS * SEATS * SUITS, RANKS, rank_label},
+    {"trump", ROUNDS * SEATS, SUITS, suit_label},
+    {"maker", ROUNDS, SEATS, seat_label},
+    {"round", 1, ROUNDS, round_label},
+  };
+  const uint64_t all = hands();
+  os << fixed << setprecision(1);
+  for (const Breakdown &b : BREAKDOWNS) {
+    os << '\n' << left << setw(16) << b.title << right << setw(12) << "hands"
+       << setw(8) << "share" << setw(11) << "maker pts" << setw(8) << "march"
+       << setw(8) << "euchre" << '\n';
+    for (int row = 0; row < b.rows; ++row) {
+      uint64_t sum[NUM_OUTCOMES] = {0, 0, 0, 0};
+      for (int cell = 0; cell < CELLS; ++cell) {
+        if ((cell / b.stride) % b.rows != row) continue;
+        for (int k = 0; k < NUM_OUTCOMES; ++k) {
+          sum[k] += counts[cell * NUM_OUTCOMES + k];
+        }
+      }
+      double points = sum[HANDS] ? static_cast<double>(sum[MAKER_POINTS]) /
+                                   static_cast<double>(sum[HANDS]) : 0;
+      os << left << setw(16) << b.label(row) << right
+         << setw(12) << sum[HANDS]
+         << setw(7) << percent(sum[HANDS], all) << '%'
+         << setw(11) << setprecision(3) << points << setprecision(1)
+         << setw(7) << percent(sum[MARCHES], sum[HANDS]) << '%'
+         << setw(7) << percent(sum[EUCHRES], sum[HANDS]) << '%' << '\n';
+    }
+  }
+  const uint64_t thrown_in = counts[CELLS * NUM_OUTCOMES];
+  if (thrown_in) {
+    os << "\nthrown in " << thrown_in << " ("
+       << percent(thrown_in, all) << "%)\n";
+  }
+}
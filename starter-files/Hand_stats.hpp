@@ -0,0 +1,68 @@
+#ifndef HAND_STATS_HPP
+#define HAND_STATS_HPP
+/* Hand_stats.hpp
+ *
+ * Outcomes of hands broken down by situation: the rank of the upcard, the
+ * trump suit, the maker's seat relative to the dealer and the bidding round
+ * in which trump was made.  For every combination it counts the hands, the
+ * points the makers scored, marches and euchres.
+ *
+ * The counters are one fixed-size array in a cache-line-aligned object, so
+ * each thread of a simulation keeps its own without sharing lines with the
+ * others and adding a hand is four increments.  Merge the threads' objects
+ * when they are done.
+ */
+
+#include "Game.hpp"
+#include <cstdint>
+#include <iostream>
+
+class alignas(64) Hand_stats {
+public:
+  static const int RANKS = 6;    // upcard Nine through Ace
+  static const int SUITS = 4;
+  static const int SEATS = 4;    // maker's seat counted left from the dealer
+  static const int ROUNDS = 3;   // round 3: the dealer was stuck
+  static const int CELLS = RANKS * SUITS * SEATS * ROUNDS;
+  enum Outcome { HANDS, MAKER_POINTS, MARCHES, EUCHRES, NUM_OUTCOMES };
+  static const int NUM_COUNTS = CELLS * NUM_OUTCOMES + 1;
+
+  //REQUIRES hr comes from a pack of euchre cards (Nine through Ace)
+  //MODIFIES *this
+  //EFFECTS Counts the hand
+  void add(const Hand_result &hr) {
+    if (hr.thrown_in) {
+      ++counts[CELLS * NUM_OUTCOMES];
+      return;
+    }
+    int seat = (hr.maker - hr.dealer + 4) % 4;
+    int cell = ((hr.upcard.get_rank() - NINE) * SUITS + hr.trump) * SEATS;
+    cell = ((cell + seat) * ROUNDS + hr.round - 1) * NUM_OUTCOMES;
+    ++counts[cell + HANDS];
+    counts[cell + MAKER_POINTS] += static_cast<std::uint64_t>(
+      hr.points[hr.maker % 2]);
+    counts[cell + MARCHES] += hr.march;
+    counts[cell + EUCHRES] += hr.euchred;
+  }
+
+  //MODIFIES *this
+  //EFFECTS Adds the counts of other to these
+  void merge(const Hand_stats &other);
+
+  //EFFECTS Returns the number of hands counted, thrown in or not
+  std::uint64_t hands() const;
+
+  //EFFECTS Returns the NUM_COUNTS counters, for saving and restoring
+  std::uint64_t * data() { return counts; }
+  const std::uint64_t * data() const { return counts; }
+
+  //EFFECTS Prints one table per situation: hands, share of all hands,
+  //  maker points per hand, and march and euchre rates
+  void print(std::ostream &os) const;
+
+private:
+  // Per cell, NUM_OUTCOMES counters; then the hands thrown in
+  std::uint64_t counts[NUM_COUNTS] = {};
+};
+
+#endif // HAND_STATS_HPP
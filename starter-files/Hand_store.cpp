@@ -0,0 +1,368 @@
+// Hand_store.cpp
+#include "Hand_store.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace std;
+
+static const uint64_t STORE_MAGIC = 0x3153444e41485545ULL; // "EUHANDS1"
+static const size_t HEADER_WORDS = 4;
+static const int BLOCK_ROWS = Hand_store_writer::BLOCK_ROWS;
+
+static const char *const COLUMN_NAMES[NUM_HAND_COLUMNS] = {
+  "dealer", "upcard", "round", "maker", "maker_pos", "trump", "alone",
+  "maker_tricks", "maker_points", "defender_points", "march", "euchred",
+  "maker_trumps", "maker_right", "maker_left",
+  "hand0", "hand1", "hand2", "hand3",
+};
+
+const char * hand_column_name(int c) { return COLUMN_NAMES[c]; }
+
+int find_hand_column(const string &name) {
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+    if (name == COLUMN_NAMES[c]) return c;
+  }
+  return -1;
+}
+
+// Euchre cards are ranks Nine to Ace, bits 28-51 of a Card_set
+static uint32_t euchre_bits(Card_set cards) {
+  return static_cast<uint32_t>(cards >> (NINE * 4)) & 0xffffff;
+}
+
+Hand_row make_hand_row(const Hand_result &hr, const Card_set dealt[]) {
+  Hand_row row;
+  uint32_t *v = row.value;
+  v[COL_DEALER] = static_cast<uint32_t>(hr.dealer);
+  v[COL_UPCARD] = (hr.upcard.get_rank() - NINE) * 4 + hr.upcard.get_suit();
+  for (int seat = 0; seat < 4; ++seat) {
+    v[COL_HAND0 + seat] = euchre_bits(dealt[seat]);
+  }
+  if (hr.thrown_in) return row;
+
+  const int makers = hr.maker % 2;
+  v[COL_ROUND] = static_cast<uint32_t>(hr.round);
+  v[COL_MAKER] = static_cast<uint32_t>(hr.maker);
+  v[COL_MAKER_POS] = static_cast<uint32_t>((hr.maker - hr.dealer + 4) % 4);
+  v[COL_TRUMP] = hr.trump;
+  v[COL_ALONE] = hr.alone != -1;
+  v[COL_MAKER_TRICKS] = static_cast<uint32_t>(hr.tricks[makers]);
+  v[COL_MAKER_POINTS] = static_cast<uint32_t>(hr.points[makers]);
+  v[COL_DEFENDER_POINTS] = static_cast<uint32_t>(hr.points[1 - makers]);
+  v[COL_MARCH] = hr.march;
+  v[COL_EUCHRED] = hr.euchred;
+
+  Card_set held = dealt[hr.maker];
+  if (hr.round == 1 && hr.maker == hr.dealer) held |= card_bit(hr.upcard);
+  const Card_set trumps = held & suit_cards(hr.trump, hr.trump);
+  v[COL_MAKER_TRUMPS] = static_cast<uint32_t>(__builtin_popcountll(trumps));
+  v[COL_MAKER_RIGHT] = (trumps & card_bit(Card(JACK, hr.trump))) != 0;
+  v[COL_MAKER_LEFT] =
+    (trumps & card_bit(Card(JACK, Suit_next(hr.trump)))) != 0;
+  return row;
+}
+
+// Block layout
+
+// Columns with few values get a bitmap per value
+static bool is_indexed(int c) {
+  return c != COL_UPCARD && c < COL_HAND0;
+}
+
+static int width_of(uint32_t range) {
+  return range ? 32 - __builtin_clz(range) : 0;
+}
+
+// Padding lets every value, even of width 0, be read from two adjacent words
+static size_t packed_words(size_t rows, int width) {
+  return rows * static_cast<size_t>(width) / 64 + 2;
+}
+
+static size_t bitmap_words(size_t rows) { return (rows + 63) / 64; }
+
+// Where everything in one block is
+struct Block_view {
+  size_t rows;
+  uint32_t min[NUM_HAND_COLUMNS];
+  uint32_t max[NUM_HAND_COLUMNS];
+  const uint64_t *packed[NUM_HAND_COLUMNS];
+  const uint64_t *bitmaps[NUM_HAND_COLUMNS];  // null if not indexed
+  size_t words;                               // size of the whole block
+};
+
+// Reads the header of the block at b, of which at most avail words exist.
+// Returns false if the block is malformed or does not fit.
+static bool view_block(const uint64_t *b, size_t avail, Block_view &view) {
+  if (avail < 1 + NUM_HAND_COLUMNS) return false;
+  view.rows = b[0];
+  if (view.rows == 0 || view.rows > static_cast<size_t>(BLOCK_ROWS)) {
+    return false;
+  }
+  size_t pos = 1 + NUM_HAND_COLUMNS;
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+    view.min[c] = static_cast<uint32_t>(b[1 + c]);
+    view.max[c] = static_cast<uint32_t>(b[1 + c] >> 32);
+    if (view.min[c] > view.max[c]) return false;
+    view.packed[c] = b + pos;
+    pos += packed_words(view.rows, width_of(view.max[c] - view.min[c]));
+  }
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+    view.bitmaps[c] = nullptr;
+    if (!is_indexed(c)) continue;
+    view.bitmaps[c] = b + pos;
+    pos += (size_t(view.max[c]) - view.min[c] + 1) * bitmap_words(view.rows);
+  }
+  view.words = pos;
+  return pos <= avail;
+}
+
+// Writer
+
+Hand_store_writer::Hand_store_writer(const string &path)
+  : out(path, ios::binary | ios::trunc), rows(0), closed(false) {
+  for (vector<uint32_t> &column : columns) column.reserve(BLOCK_ROWS);
+  const uint64_t header[HEADER_WORDS] = {
+    STORE_MAGIC, NUM_HAND_COLUMNS, BLOCK_ROWS, 0
+  };
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+}
+
+Hand_store_writer::~Hand_store_writer() {
+  if (!closed) close();
+}
+
+bool Hand_store_writer::good() const { return out.good(); }
+
+void Hand_store_writer::add(const Hand_row &row) {
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+    columns[c].push_back(row.value[c]);
+  }
+  if (columns[0].size() == static_cast<size_t>(BLOCK_ROWS)) flush_block();
+}
+
+void Hand_store_writer::flush_block() {
+  const size_t n = columns[0].size();
+  if (n == 0) return;
+  vector<uint64_t> words(1 + NUM_HAND_COLUMNS);
+  words[0] = n;
+  uint32_t min[NUM_HAND_COLUMNS];
+  uint32_t max[NUM_HAND_COLUMNS];
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+    auto range = minmax_element(columns[c].begin(), columns[c].end());
+    min[c] = *range.first;
+    max[c] = *range.second;
+    words[1 + c] = min[c] | uint64_t(max[c]) << 32;
+  }
+
+  // Each value, less the minimum, in width bits at bit i * width
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+    const int width = width_of(max[c] - min[c]);
+    vector<uint64_t> packed(packed_words(n, width), 0);
+    for (size_t i = 0; i < n; ++i) {
+      const uint64_t v = columns[c][i] - min[c];
+      const size_t bit = i * static_cast<size_t>(width);
+      const size_t w = bit / 64, s = bit % 64;
+      packed[w] |= v << s;
+      if (s + static_cast<size_t>(width) > 64) packed[w + 1] |= v >> (64 - s);
+    }
+    words.insert(words.end(), packed.begin(), packed.end());
+  }
+
+  const size_t bw = bitmap_words(n);
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+    if (!is_indexed(c)) continue;
+    vector<uint64_t> bitmaps((size_t(max[c]) - min[c] + 1) * bw, 0);
+    for (size_t i = 0; i < n; ++i) {
+      bitmaps[(columns[c][i] - min[c]) * bw + i / 64] |= uint64_t(1) << (i % 64);
+    }
+    words.insert(words.end(), bitmaps.begin(), bitmaps.end());
+  }
+
+  out.write(reinterpret_cast<const char *>(words.data()),
+            static_cast<streamsize>(words.size() * sizeof(uint64_t)));
+  rows += n;
+  for (vector<uint32_t> &column : columns) column.clear();
+}
+
+bool Hand_store_writer::close() {
+  closed = true;
+  flush_block();
+  out.seekp(static_cast<streamoff>((HEADER_WORDS - 1) * sizeof(uint64_t)));
+  out.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+  out.close();
+  return !out.fail();
+}
+
+// Reader
+
+Hand_store::Hand_store(const string &path)
+  : file(path), num_rows(0), valid(false) {
+  if (!file.is_open() || file.size() % sizeof(uint64_t) != 0 ||
+      file.size() < HEADER_WORDS * sizeof(uint64_t)) {
+    return;
+  }
+  // Mappings are page-aligned, so the words can be read in place
+  const uint64_t *w = reinterpret_cast<const uint64_t *>(file.data());
+  const size_t total = file.size() / sizeof(uint64_t);
+  if (w[0] != STORE_MAGIC || w[1] != NUM_HAND_COLUMNS ||
+      w[2] != static_cast<uint64_t>(BLOCK_ROWS)) {
+    return;
+  }
+  uint64_t counted = 0;
+  for (size_t pos = HEADER_WORDS; pos < total;) {
+    Block_view view;
+    if (!view_block(w + pos, total - pos, view)) return;
+    blocks.push_back(w + pos);
+    counted += view.rows;
+    pos += view.words;
+  }
+  num_rows = w[3];
+  valid = counted == num_rows;
+}
+
+bool Hand_store::is_open() const { return valid; }
+
+uint64_t Hand_store::rows() const { return num_rows; }
+
+uint32_t Hand_store::max_value(int c) const {
+  uint32_t max = 0;
+  for (const uint64_t *b : blocks) {
+    max = std::max(max, static_cast<uint32_t>(b[1 + c] >> 32));
+  }
+  return max;
+}
+
+// Decodes the n values of a packed column
+static void unpack(const uint64_t *packed, int width, uint32_t base, size_t n,
+                   uint32_t out[]) {
+  const uint64_t mask = (uint64_t(1) << width) - 1;
+  for (size_t i = 0; i < n; ++i) {
+    const size_t bit = i * static_cast<size_t>(width);
+    const uint64_t *w = packed + bit / 64;
+    const unsigned s = bit % 64;
+    // The high word's part; shifting in two steps makes s == 0 contribute 0
+    const uint64_t x = (w[0] >> s) | ((w[1] << 1) << (63 - s));
+    out[i] = static_cast<uint32_t>(x & mask) + base;
+  }
+}
+
+static void unpack(const Block_view &view, int c, uint32_t out[]) {
+  unpack(view.packed[c], width_of(view.max[c] - view.min[c]), view.min[c],
+         view.rows, out);
+}
+
+// Rows a filter keeps: values in [lo, hi], or outside it if negated
+struct Interval {
+  int64_t lo;
+  int64_t hi;
+  bool negate;
+};
+
+static Interval interval_of(const Hand_filter &f) {
+  const int64_t v = f.value;
+  const int64_t top = UINT32_MAX;
+  switch (f.op) {
+  case Hand_filter::EQ: return {v, v, false};
+  case Hand_filter::NE: return {v, v, true};
+  case Hand_filter::LT: return {0, v - 1, false};
+  case Hand_filter::LE: return {0, v, false};
+  case Hand_filter::GT: return {v + 1, top, false};
+  case Hand_filter::GE: return {v, top, false};
+  }
+  assert(false);
+  return {0, top, false};
+}
+
+// Sets mask to the rows of the block whose column c lies in [lo, hi], which
+// is within the block's min and max.  Indexed columns OR their bitmaps;
+// others are decoded into buf and compared 64 rows to a word.
+static void match_rows(const Block_view &view, int c, uint32_t lo,
+                       uint32_t hi, uint32_t buf[], uint64_t mask[]) {
+  const size_t bw = bitmap_words(view.rows);
+  if (view.bitmaps[c]) {
+    const uint64_t *bitmap = view.bitmaps[c] + (lo - view.min[c]) * bw;
+    memcpy(mask, bitmap, bw * sizeof(uint64_t));
+    for (uint32_t v = lo + 1; v <= hi; ++v) {
+      bitmap += bw;
+      for (size_t k = 0; k < bw; ++k) mask[k] |= bitmap[k];
+    }
+    return;
+  }
+  unpack(view, c, buf);
+  const uint32_t span = hi - lo;
+  for (size_t k = 0; k < bw; ++k) {
+    uint64_t m = 0;
+    for (int j = 0; j < 64; ++j) {
+      m |= uint64_t(buf[k * 64 + j] - lo <= span) << j;
+    }
+    mask[k] = m;
+  }
+}
+
+// Narrows sel to the rows of the block that pass f.  Returns false if none
+// can, judging by the block's min and max alone.
+static bool apply_filter(const Block_view &view, const Hand_filter &f,
+                         uint32_t buf[], uint64_t sel[]) {
+  const Interval in = interval_of(f);
+  const int64_t lo = max<int64_t>(in.lo, view.min[f.column]);
+  const int64_t hi = min<int64_t>(in.hi, view.max[f.column]);
+  const bool none = lo > hi;
+  const bool all = in.lo <= view.min[f.column] && in.hi >= view.max[f.column];
+  if (none || all) return none == in.negate;
+
+  uint64_t mask[BLOCK_ROWS / 64];
+  match_rows(view, f.column, static_cast<uint32_t>(lo),
+             static_cast<uint32_t>(hi), buf, mask);
+  const size_t bw = bitmap_words(view.rows);
+  for (size_t k = 0; k < bw; ++k) {
+    sel[k] &= in.negate ? ~mask[k] : mask[k];
+  }
+  return true;
+}
+
+Hand_query_result Hand_store::run(const Hand_query &q) const {
+  Hand_query_result result;
+  const size_t groups = q.group_by < 0 ? 1 : max_value(q.group_by) + size_t(1);
+  assert(groups <= static_cast<size_t>(MAX_GROUPS));
+  result.count.assign(groups, 0);
+  result.sum.assign(groups, 0);
+
+  vector<uint32_t> buf(BLOCK_ROWS, 0), group(BLOCK_ROWS, 0),
+                   value(BLOCK_ROWS, 0);
+  uint64_t sel[BLOCK_ROWS / 64];
+  for (const uint64_t *b : blocks) {
+    ++result.blocks;
+    Block_view view;
+    view_block(b, SIZE_MAX, view);
+    const size_t bw = bitmap_words(view.rows);
+    fill(sel, sel + bw, ~uint64_t(0));
+    if (view.rows % 64) sel[bw - 1] = (uint64_t(1) << (view.rows % 64)) - 1;
+
+    bool any = true;
+    for (size_t i = 0; i < q.filters.size() && any; ++i) {
+      any = apply_filter(view, q.filters[i], buf.data(), sel);
+    }
+    if (!any) {
+      ++result.blocks_skipped;
+      continue;
+    }
+
+    if (q.group_by < 0 && q.average < 0) {
+      for (size_t k = 0; k < bw; ++k) {
+        result.count[0] += static_cast<uint64_t>(__builtin_popcountll(sel[k]));
+      }
+      continue;
+    }
+    if (q.group_by >= 0) unpack(view, q.group_by, group.data());
+    if (q.average >= 0) unpack(view, q.average, value.data());
+    for (size_t k = 0; k < bw; ++k) {
+      for (uint64_t m = sel[k]; m; m &= m - 1) {
+        const size_t i = k * 64 + static_cast<size_t>(__builtin_ctzll(m));
+        ++result.count[group[i]];
+        result.sum[group[i]] += value[i];
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,159 @@
+#ifndef HAND_STORE_HPP
+#define HAND_STORE_HPP
+/* Hand_store.hpp
+ *
+ * On-disk columnar store of per-hand facts, and scans over it.
+ *
+ * Rows are grouped in blocks of BLOCK_ROWS hands.  Within a block every
+ * column is stored on its own, bit-packed relative to the block's minimum
+ * in just enough bits for its maximum, and the minimum and maximum are kept
+ * in the block header so that a scan skips blocks no row of which can
+ * match.  Columns with few values also get a bitmap per value, so that
+ * filters on them are word-wide ANDs and ORs with no decoding at all.
+ *
+ * The file is memory-mapped for reading and scanned a block at a time:
+ * filters build a selection bitmap over the block, and only the columns
+ * being aggregated are decoded.
+ *
+ * File layout, all 64-bit words in host byte order:
+ *   header: magic, NUM_HAND_COLUMNS, BLOCK_ROWS, number of rows
+ *   each block: its number of rows; per column, min | max << 32; per
+ *     column, the packed values and padding; per indexed column, for each
+ *     value from min to max, a bitmap of the rows
+ */
+
+#include "Game.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Columns in the order they are stored.  Maker columns are 0 for hands
+// thrown in.
+enum Hand_column {
+  COL_DEALER,          // seat 0-3
+  COL_UPCARD,          // (rank - Nine) * 4 + suit: 0 Nine of Spades ... 23
+  COL_ROUND,           // 1 or 2, 3 if the dealer was stuck, 0 if thrown in
+  COL_MAKER,           // seat 0-3
+  COL_MAKER_POS,       // maker's seat counted left from the dealer
+  COL_TRUMP,           // Suit
+  COL_ALONE,           // 1 if the maker went alone
+  COL_MAKER_TRICKS,
+  COL_MAKER_POINTS,
+  COL_DEFENDER_POINTS,
+  COL_MARCH,           // 0 or 1
+  COL_EUCHRED,         // 0 or 1
+  COL_MAKER_TRUMPS,    // trumps the maker held: its five cards, and the
+  COL_MAKER_RIGHT,     //   upcard if it dealt and picked it up; whether
+  COL_MAKER_LEFT,      //   they included the right and left bowers
+  COL_HAND0,           // cards dealt to seats 0-3, bit (rank - Nine) * 4 + suit
+  COL_HAND1,
+  COL_HAND2,
+  COL_HAND3,
+  NUM_HAND_COLUMNS
+};
+
+//EFFECTS Returns the name of column c, for example "maker_trumps"
+const char * hand_column_name(int c);
+
+//EFFECTS Returns the column named name, or -1 if there is none
+int find_hand_column(const std::string &name);
+
+// One hand's values, indexed by Hand_column
+struct Hand_row {
+  std::uint32_t value[NUM_HAND_COLUMNS] = {};
+};
+
+//REQUIRES dealt holds the hands dealt for the hand hr describes, which was
+//  played with a pack of euchre cards
+//EFFECTS Returns the facts of that hand
+Hand_row make_hand_row(const Hand_result &hr, const Card_set dealt[]);
+
+class Hand_store_writer {
+public:
+  static const int BLOCK_ROWS = 4096;
+
+  // EFFECTS: Creates or truncates the store at path
+  explicit Hand_store_writer(const std::string &path);
+
+  // EFFECTS: Finishes the store if close() was not called
+  ~Hand_store_writer();
+
+  Hand_store_writer(const Hand_store_writer &) = delete;
+  Hand_store_writer & operator=(const Hand_store_writer &) = delete;
+
+  // EFFECTS: Returns true if the file was created and every write so far
+  //          succeeded
+  bool good() const;
+
+  // EFFECTS: Appends row to the store
+  void add(const Hand_row &row);
+
+  // EFFECTS: Writes the last block and the final header, and returns good()
+  bool close();
+
+private:
+  void flush_block();
+
+  std::ofstream out;
+  std::vector<std::uint32_t> columns[NUM_HAND_COLUMNS];
+  std::uint64_t rows;
+  bool closed;
+};
+
+// Keeps rows whose column compares to value
+struct Hand_filter {
+  enum Op { EQ, NE, LT, LE, GT, GE };
+  int column;
+  Op op;
+  std::uint32_t value;
+};
+
+struct Hand_query {
+  std::vector<Hand_filter> filters;   // all must hold
+  int group_by = -1;                  // column to group by, or -1
+  int average = -1;                   // column to sum and average, or -1
+};
+
+struct Hand_query_result {
+  std::uint64_t blocks = 0;
+  std::uint64_t blocks_skipped = 0;   // by min/max alone
+  // Per value of the group-by column (one group without one): rows that
+  // passed the filters, and the sum of the averaged column over them
+  std::vector<std::uint64_t> count;
+  std::vector<std::uint64_t> sum;
+};
+
+class Hand_store {
+public:
+  static const int MAX_GROUPS = 256;
+
+  // EFFECTS: Maps the store at path.  is_open() is false if it cannot be
+  //          mapped or is not a complete store.
+  explicit Hand_store(const std::string &path);
+
+  Hand_store(const Hand_store &) = delete;
+  Hand_store & operator=(const Hand_store &) = delete;
+
+  bool is_open() const;
+
+  // EFFECTS: Returns the number of hands in the store
+  std::uint64_t rows() const;
+
+  // REQUIRES: is_open(), and every column of q exists; the group-by column
+  //           has fewer than MAX_GROUPS values
+  // EFFECTS: Scans the store
+  Hand_query_result run(const Hand_query &q) const;
+
+  // EFFECTS: Returns the largest value of column c in the store
+  std::uint32_t max_value(int c) const;
+
+private:
+  MappedFile file;
+  std::vector<const std::uint64_t *> blocks;
+  std::uint64_t num_rows;
+  bool valid;
+};
+
+#endif // HAND_STORE_HPP
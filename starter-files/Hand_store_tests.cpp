@@ -0,0 +1,129 @@
+// Hand_store Tests
+#include "Hand_store.hpp"
+#include "Rng.hpp"
+#include "unit_test_framework.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Each test writes its own store, so that tests can run in parallel (-j)
+static const char *const QUERY_STORE = "Hand_store_tests_query.db";
+static const char *const SKIP_STORE = "Hand_store_tests_skip.db";
+
+// Rows with random values in each column's range, written to path as three
+// full blocks and a partial one.  Alone is 1 only in the second block, so
+// that filters on it can skip the others.
+static vector<Hand_row> write_random_rows(const char *path, uint64_t seed) {
+    const uint32_t LIMITS[NUM_HAND_COLUMNS] = {
+        4, 24, 4, 4, 4, 4, 2, 6, 5, 5, 2, 2, 7, 2, 2,
+        1u << 24, 1u << 24, 1u << 24, 1u << 24
+    };
+    Rng rng(seed);
+    vector<Hand_row> rows(3 * Hand_store_writer::BLOCK_ROWS + 100);
+    Hand_store_writer writer(path);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (int c = 0; c < NUM_HAND_COLUMNS; ++c) {
+            rows[i].value[c] = static_cast<uint32_t>(rng.below(LIMITS[c]));
+        }
+        if (i / Hand_store_writer::BLOCK_ROWS != 1) rows[i].value[COL_ALONE] = 0;
+        writer.add(rows[i]);
+    }
+    ASSERT_TRUE(writer.close());
+    return rows;
+}
+
+static bool passes(const Hand_row &row, const Hand_filter &f) {
+    uint32_t v = row.value[f.column];
+    switch (f.op) {
+    case Hand_filter::EQ: return v == f.value;
+    case Hand_filter::NE: return v != f.value;
+    case Hand_filter::LT: return v < f.value;
+    case Hand_filter::LE: return v <= f.value;
+    case Hand_filter::GT: return v > f.value;
+    case Hand_filter::GE: return v >= f.value;
+    }
+    return false;
+}
+
+// Checks q against a row-by-row evaluation
+static void check_query(const Hand_store &store, const vector<Hand_row> &rows,
+                        const Hand_query &q) {
+    Hand_query_result r = store.run(q);
+    vector<uint64_t> count(r.count.size(), 0), sum(r.sum.size(), 0);
+    for (const Hand_row &row : rows) {
+        bool keep = true;
+        for (const Hand_filter &f : q.filters) keep = keep && passes(row, f);
+        if (!keep) continue;
+        size_t g = q.group_by < 0 ? 0 : row.value[q.group_by];
+        ++count[g];
+        if (q.average >= 0) sum[g] += row.value[q.average];
+    }
+    ASSERT_TRUE(count == r.count);
+    ASSERT_TRUE(sum == r.sum);
+}
+
+TEST(test_store_queries_match_row_by_row) {
+    vector<Hand_row> rows = write_random_rows(QUERY_STORE, 1);
+    Hand_store store(QUERY_STORE);
+    ASSERT_TRUE(store.is_open());
+    ASSERT_EQUAL(store.rows(), uint64_t(rows.size()));
+
+    // Indexed and packed columns, every operator, groups and sums
+    Hand_query q;
+    check_query(store, rows, q);
+    q.filters = {{COL_MAKER_TRUMPS, Hand_filter::EQ, 1},
+                 {COL_MAKER_LEFT, Hand_filter::EQ, 1}};
+    q.average = COL_EUCHRED;
+    check_query(store, rows, q);
+    q.filters = {{COL_UPCARD, Hand_filter::GE, 20},
+                 {COL_TRUMP, Hand_filter::NE, 2},
+                 {COL_HAND0, Hand_filter::LT, 1u << 23}};
+    q.group_by = COL_MAKER_POS;
+    q.average = COL_HAND3;
+    check_query(store, rows, q);
+    q.filters = {{COL_MAKER_TRICKS, Hand_filter::GT, 2},
+                 {COL_UPCARD, Hand_filter::LE, 3}};
+    q.group_by = COL_UPCARD;
+    q.average = -1;
+    check_query(store, rows, q);
+}
+
+TEST(test_store_skips_blocks_by_min_and_max) {
+    vector<Hand_row> rows = write_random_rows(SKIP_STORE, 2);
+    Hand_store store(SKIP_STORE);
+    Hand_query q;
+    q.filters = {{COL_ALONE, Hand_filter::EQ, 1}};
+    Hand_query_result r = store.run(q);
+    ASSERT_EQUAL(r.blocks, uint64_t(4));
+    ASSERT_EQUAL(r.blocks_skipped, uint64_t(3));
+    check_query(store, rows, q);
+
+    q.filters = {{COL_DEALER, Hand_filter::GT, 3}};
+    ASSERT_EQUAL(store.run(q).blocks_skipped, uint64_t(4));
+}
+
+TEST(test_hand_row_counts_maker_trumps) {
+    Hand_result hr;
+    hr.upcard = Card(JACK, DIAMONDS);
+    hr.maker = 1;
+    hr.round = 2;
+    hr.trump = HEARTS;
+    hr.tricks[1] = 3;
+    hr.points[1] = 1;
+    Card_set dealt[4] = {0, 0, 0, 0};
+    dealt[1] = card_bit(Card(JACK, HEARTS)) | card_bit(Card(NINE, SPADES));
+    Hand_row row = make_hand_row(hr, dealt);
+    ASSERT_EQUAL(row.value[COL_UPCARD], uint32_t((JACK - NINE) * 4 + DIAMONDS));
+    ASSERT_EQUAL(row.value[COL_MAKER_POS], uint32_t(1));
+    ASSERT_EQUAL(row.value[COL_MAKER_TRUMPS], uint32_t(1));
+    ASSERT_EQUAL(row.value[COL_MAKER_RIGHT], uint32_t(1));
+    ASSERT_EQUAL(row.value[COL_MAKER_LEFT], uint32_t(0));
+    ASSERT_EQUAL(row.value[COL_MAKER_POINTS], uint32_t(1));
+    const int jack_of_hearts = (JACK - NINE) * 4 + HEARTS;
+    ASSERT_EQUAL(row.value[COL_HAND1], uint32_t(1 << jack_of_hearts | 1));
+}
+
+TEST_MAIN()
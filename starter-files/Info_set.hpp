@@ -0,0 +1,112 @@
+#ifndef INFO_SET_HPP
+#define INFO_SET_HPP
+/* Info_set.hpp
+ *
+ * Public history of the hand in progress: the upcard and what became of
+ * it, who made trump, every card each seat has played, the suits each seat
+ * has shown it is void in, and the trick so far.  The engine keeps it in
+ * Game_state and updates it as each hand is played; players see it through
+ * a const reference (Player::watch), so reading it costs nothing.
+ */
+
+#include "Card.hpp"
+
+class Info_set {
+public:
+  //EFFECTS Returns the seat that dealt this hand
+  int get_dealer() const { return dealer; }
+
+  //EFFECTS Returns the card turned up for bidding
+  const Card & get_upcard() const { return upcard; }
+
+  //EFFECTS Returns true if trump has been made
+  bool trump_made() const { return maker != -1; }
+
+  //REQUIRES trump_made()
+  //EFFECTS Returns the seat that ordered up trump, and trump
+  int get_maker() const { return maker; }
+  Suit get_trump() const { return trump; }
+
+  //EFFECTS Returns true if the dealer picked up the upcard.  The card it
+  //  discarded instead is not public.
+  bool upcard_picked_up() const { return picked_up; }
+
+  //EFFECTS Returns true if seat sits this hand out because its partner
+  //  plays alone
+  bool sits_out(int seat) const { return out & (1u << seat); }
+
+  //EFFECTS Returns the cards seat has played this hand
+  Card_set played(int seat) const { return played_by[seat]; }
+
+  //EFFECTS Returns every card played this hand
+  Card_set played() const {
+    return played_by[0] | played_by[1] | played_by[2] | played_by[3];
+  }
+
+  //EFFECTS Returns true if seat has failed to follow suit s (with the left
+  //  bower counted as trump), so it holds no more cards of s
+  bool is_void(int seat, Suit s) const { return voids[seat] & (1u << s); }
+
+  //EFFECTS Returns the number of cards in the current trick, up to one
+  //  per seat playing.  A full trick stays visible until the next is led.
+  int trick_size() const { return trick_cards; }
+
+  //REQUIRES trick_size() > 0
+  //EFFECTS Returns the seat that led the current trick
+  int trick_leader() const { return leader; }
+
+  //REQUIRES 0 <= i < trick_size()
+  //EFFECTS Returns the i-th card of the current trick; card 0 was led
+  const Card & trick_card(int i) const { return trick[i]; }
+
+  // Updated by the engine only
+
+  //EFFECTS Clears the history for a hand dealt by dealer_in
+  void begin_hand(int dealer_in, const Card &upcard_in) {
+    *this = Info_set();
+    dealer = dealer_in;
+    upcard = upcard_in;
+  }
+
+  void make_trump(int maker_in, Suit trump_in, bool picked_up_in) {
+    maker = maker_in;
+    trump = trump_in;
+    picked_up = picked_up_in;
+  }
+
+  // A dealer sitting out does not pick up the upcard
+  void sit_out(int seat) {
+    out |= 1u << seat;
+    if (seat == dealer) picked_up = false;
+    --trick_length;
+  }
+
+  //REQUIRES trump_made()
+  void play(int seat, const Card &c) {
+    if (trick_cards == trick_length) trick_cards = 0;
+    if (trick_cards == 0) {
+      leader = seat;
+    } else {
+      Suit led_suit = trick[0].get_suit(trump);
+      if (c.get_suit(trump) != led_suit) voids[seat] |= 1u << led_suit;
+    }
+    trick[trick_cards++] = c;
+    played_by[seat] |= card_bit(c);
+  }
+
+private:
+  int dealer = 0;
+  Card upcard;
+  int maker = -1;
+  Suit trump = SPADES;
+  bool picked_up = false;
+  Card_set played_by[4] = {0, 0, 0, 0};
+  unsigned voids[4] = {0, 0, 0, 0};   // bit s: void in suit s
+  unsigned out = 0;     // bit seat: seat sits out
+  Card trick[4];
+  int trick_length = 4;
+  int trick_cards = 0;
+  int leader = 0;
+};
+
+#endif // INFO_SET_HPP
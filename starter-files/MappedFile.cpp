@@ -0,0 +1,45 @@
+// MappedFile.cpp
+#include "MappedFile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+MappedFile::MappedFile(const string &path)
+  : bytes(nullptr), length(0), mapped(false) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0) {
+      // mmap rejects empty ranges; an empty file is still a valid file.
+      bytes = "";
+      mapped = true;
+    } else {
+      void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        bytes = static_cast<const char *>(p);
+        mapped = true;
+      } else {
+        length = 0;
+      }
+    }
+  }
+  close(fd); // the mapping stays valid after the descriptor is closed
+}
+
+MappedFile::~MappedFile() {
+  if (mapped && length > 0) {
+    munmap(const_cast<char *>(bytes), length);
+  }
+}
+
+bool MappedFile::is_open() const { return mapped; }
+
+const char * MappedFile::data() const { return bytes; }
+
+size_t MappedFile::size() const { return length; }
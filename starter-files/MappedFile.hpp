@@ -0,0 +1,40 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+/* MappedFile.hpp
+ *
+ * Read-only memory mapping of a whole file
+ */
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+  // EFFECTS: Maps the file at path read-only.  If the file cannot be opened
+  //          or mapped, the MappedFile is empty and is_open() returns false.
+  explicit MappedFile(const std::string &path);
+
+  // EFFECTS: Unmaps the file
+  ~MappedFile();
+
+  // A mapping is owned by exactly one MappedFile
+  MappedFile(const MappedFile &) = delete;
+  MappedFile & operator=(const MappedFile &) = delete;
+
+  // EFFECTS: Returns true if the file was opened and mapped
+  bool is_open() const;
+
+  // EFFECTS: Returns the first byte of the file.  The bytes are not
+  //          NUL-terminated.
+  const char * data() const;
+
+  // EFFECTS: Returns the number of bytes in the file
+  std::size_t size() const;
+
+private:
+  const char *bytes;
+  std::size_t length;
+  bool mapped;
+};
+
+#endif // MAPPEDFILE_HPP
@@ -0,0 +1,428 @@
+// Neural.cpp
+#include "Neural.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+// The AVX2 kernel is compiled for AVX2 whatever the flags, and used when
+// the processor has it
+#if !defined(BATCH_SCALAR) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define MLP_AVX2 1
+#  define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+using namespace std;
+
+static const uint64_t WEIGHTS_MAGIC = 0x313030504c4d5545ULL; // "EUMLP001"
+
+// Weights
+
+bool load_mlp(const string &path, Mlp &mlp) {
+  ifstream in(path, ios::binary);
+  uint64_t magic = 0;
+  int32_t shape[3] = {0, 0, 0};
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(shape), sizeof(shape));
+  if (!in || magic != WEIGHTS_MAGIC || shape[0] != Mlp::INPUTS ||
+      shape[1] != Mlp::HIDDEN || shape[2] < 0 || shape[2] > 30) {
+    return false;
+  }
+  mlp.shift = shape[2];
+  in.read(reinterpret_cast<char *>(mlp.w1), sizeof(mlp.w1));
+  in.read(reinterpret_cast<char *>(mlp.b1), sizeof(mlp.b1));
+  in.read(reinterpret_cast<char *>(mlp.w2), sizeof(mlp.w2));
+  in.read(reinterpret_cast<char *>(&mlp.b2), sizeof(mlp.b2));
+  return static_cast<bool>(in);
+}
+
+bool save_mlp(const string &path, const Mlp &mlp) {
+  ofstream out(path, ios::binary | ios::trunc);
+  const int32_t shape[3] = {Mlp::INPUTS, Mlp::HIDDEN, mlp.shift};
+  out.write(reinterpret_cast<const char *>(&WEIGHTS_MAGIC),
+            sizeof(WEIGHTS_MAGIC));
+  out.write(reinterpret_cast<const char *>(shape), sizeof(shape));
+  out.write(reinterpret_cast<const char *>(mlp.w1), sizeof(mlp.w1));
+  out.write(reinterpret_cast<const char *>(mlp.b1), sizeof(mlp.b1));
+  out.write(reinterpret_cast<const char *>(mlp.w2), sizeof(mlp.w2));
+  out.write(reinterpret_cast<const char *>(&mlp.b2), sizeof(mlp.b2));
+  out.close();
+  return !out.fail();
+}
+
+// Kernels
+
+// A hidden unit's sum shifted back down to a byte, rounding to nearest
+static int32_t requantize(int32_t sum, int32_t shift) {
+  const int32_t half = shift ? 1 << (shift - 1) : 0;
+  return min(max((sum + half) >> shift, 0), 127);
+}
+
+void mlp_evaluate_reference(const Mlp &mlp, const Neural_row rows[], int n,
+                            int32_t scores[]) {
+  for (int r = 0; r < n; ++r) {
+    int32_t out = mlp.b2;
+    for (int h = 0; h < Mlp::HIDDEN; ++h) {
+      int32_t sum = mlp.b1[h];
+      for (int i = 0; i < Mlp::INPUTS; ++i) sum += rows[r].x[i] * mlp.w1[h][i];
+      out += requantize(sum, mlp.shift) * mlp.w2[h];
+    }
+    scores[r] = out;
+  }
+}
+
+#if MLP_AVX2
+
+static_assert(Mlp::INPUTS == 64 && Mlp::HIDDEN % 8 == 0,
+              "kernels assume two registers of inputs and units in eights");
+
+AVX2_TARGET static inline __m256i load(const void *p) {
+  return _mm256_load_si256(static_cast<const __m256i *>(p));
+}
+
+// Products of byte inputs and weights, summed in 32-bit pairs of pairs.
+// Inputs are at most 127 and weights at most 127 in size, so the 16-bit
+// pair sums never saturate.
+AVX2_TARGET static inline __m256i dot_parts(__m256i x, const int8_t *w) {
+  return _mm256_madd_epi16(_mm256_maddubs_epi16(x, load(w)),
+                           _mm256_set1_epi16(1));
+}
+
+// Sums of each of eight vectors, in order
+AVX2_TARGET static inline __m256i sum8(const __m256i v[8]) {
+  const __m256i a = _mm256_hadd_epi32(_mm256_hadd_epi32(v[0], v[1]),
+                                      _mm256_hadd_epi32(v[2], v[3]));
+  const __m256i b = _mm256_hadd_epi32(_mm256_hadd_epi32(v[4], v[5]),
+                                      _mm256_hadd_epi32(v[6], v[7]));
+  return _mm256_add_epi32(_mm256_permute2x128_si256(a, b, 0x20),
+                          _mm256_permute2x128_si256(a, b, 0x31));
+}
+
+AVX2_TARGET static int32_t evaluate_row(const Mlp &mlp,
+                                         const Neural_row &row) {
+  const __m256i x0 = load(row.x), x1 = load(row.x + 32);
+  const __m128i shift = _mm_cvtsi32_si128(mlp.shift);
+  const __m256i half = _mm256_set1_epi32(mlp.shift ? 1 << (mlp.shift - 1) : 0);
+  alignas(32) int32_t units[Mlp::HIDDEN];
+  for (int g = 0; g < Mlp::HIDDEN; g += 8) {
+    __m256i parts[8];
+    for (int j = 0; j < 8; ++j) {
+      parts[j] = _mm256_add_epi32(dot_parts(x0, mlp.w1[g + j]),
+                                  dot_parts(x1, mlp.w1[g + j] + 32));
+    }
+    __m256i sums = _mm256_add_epi32(sum8(parts), load(mlp.b1 + g));
+    sums = _mm256_sra_epi32(_mm256_add_epi32(sums, half), shift);
+    sums = _mm256_min_epi32(_mm256_max_epi32(sums, _mm256_setzero_si256()),
+                            _mm256_set1_epi32(127));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(units + g), sums);
+  }
+  // Output layer: units times their weights, summed across the register
+  __m256i out = _mm256_setzero_si256();
+  for (int g = 0; g < Mlp::HIDDEN; g += 8) {
+    out = _mm256_add_epi32(out, _mm256_mullo_epi32(
+      load(units + g), _mm256_cvtepi8_epi32(_mm_loadl_epi64(
+        reinterpret_cast<const __m128i *>(mlp.w2 + g)))));
+  }
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(out),
+                            _mm256_extracti128_si256(out, 1));
+  s = _mm_hadd_epi32(s, s);
+  s = _mm_hadd_epi32(s, s);
+  return mlp.b2 + _mm_cvtsi128_si32(s);
+}
+
+AVX2_TARGET static void evaluate_avx2(const Mlp &mlp, const Neural_row rows[],
+                                      int n, int32_t scores[]) {
+  for (int r = 0; r < n; ++r) scores[r] = evaluate_row(mlp, rows[r]);
+}
+
+static bool has_avx2() {
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+
+#else
+
+static bool has_avx2() { return false; }
+
+#endif
+
+void mlp_evaluate(const Mlp &mlp, const Neural_row rows[], int n,
+                  int32_t scores[]) {
+#if MLP_AVX2
+  if (has_avx2()) {
+    evaluate_avx2(mlp, rows, n, scores);
+    return;
+  }
+#endif
+  mlp_evaluate_reference(mlp, rows, n, scores);
+}
+
+const char * mlp_kernels() {
+  return has_avx2() ? "AVX2" : "scalar";
+}
+
+// Features
+//
+//   0-23   the cards held, in the order below with trump as the option has it
+//   24-47  the card of the option, in the same order
+//   48-53  the kind of decision: bid in round 1 or 2, pass, discard, lead,
+//          follow
+//   54-56  bids: dealer, upcard rank, trumps held
+//   57-62  play: our team made trump, the card beats the trick so far,
+//          partner is winning it, tricks played, trumps played, cards in
+//          the trick
+//   63     always 1
+//
+// Cards are ordered relative to trump, so that what is learned for one
+// trump holds for all: trump from the Nine up to the right bower, the next
+// suit without its jack, then the suits of the other color.
+enum {
+  F_HAND = 0, F_OPTION = 24, F_BID1 = 48, F_BID2, F_PASS, F_DISCARD, F_LEAD,
+  F_FOLLOW, F_DEALER, F_UPCARD_RANK, F_TRUMPS_HELD, F_MAKERS, F_BEATS,
+  F_PARTNER_WINNING, F_TRICKS_PLAYED, F_TRUMPS_PLAYED, F_TRICK_CARDS, F_ONE
+};
+static_assert(F_ONE == Mlp::INPUTS - 1, "every input has a feature");
+
+static int relative_index(const Card &c, Suit trump) {
+  const Suit s = c.get_suit(trump);
+  const int r = c.get_rank() - NINE;          // Nine 0 ... Ace 5
+  const int plain = r > JACK - NINE ? r - 1 : r;  // without the jack
+  if (c.is_right_bower(trump)) return 6;
+  if (c.is_left_bower(trump)) return 5;
+  if (s == trump) return plain;
+  if (s == Suit_next(trump)) return 7 + plain;
+  return (s == (trump + 1) % 4 ? 12 : 18) + r;
+}
+
+static Card card_at(int bit) {
+  return Card(static_cast<Rank>(bit / 4), static_cast<Suit>(bit % 4));
+}
+
+// Zeroes row and fills in hand and the constant
+static void hand_features(Card_set hand, Suit trump, Neural_row &row) {
+  memset(row.x, 0, sizeof(row.x));
+  for (Card_set h = hand; h; h &= h - 1) {
+    row.x[F_HAND + relative_index(card_at(__builtin_ctzll(h)), trump)] = 1;
+  }
+  row.x[F_ONE] = 1;
+}
+
+static uint8_t count(Card_set cards) {
+  return static_cast<uint8_t>(__builtin_popcountll(cards));
+}
+
+void bid_options(Card_set hand, const Bidding &bid, Neural_decision &d) {
+  const int round = bid.round;
+  const bool is_dealer = bid.is_dealer;
+  assert(round == 1 || round == 2);
+  const Suit up = bid.upcard.get_suit();
+  d.options = 0;
+  for (int s = -1; s < 4; ++s) {
+    const bool pass = s < 0;
+    if (pass && round == 2 && is_dealer) continue;
+    if (!pass && (round == 1) != (s == up)) continue;
+    const Suit trump = pass ? up : static_cast<Suit>(s);
+    Neural_row &row = d.rows[d.options];
+    hand_features(hand, trump, row);
+    row.x[round == 1 ? F_BID1 : F_BID2] = 1;
+    row.x[F_PASS] = pass;
+    row.x[F_DEALER] = is_dealer;
+    row.x[F_UPCARD_RANK] = static_cast<uint8_t>(bid.upcard.get_rank() - NINE);
+    row.x[F_TRUMPS_HELD] = count(hand & suit_cards(trump, trump));
+    d.pass[d.options] = pass;
+    d.suits[d.options] = trump;
+    ++d.options;
+  }
+}
+
+void discard_options(Card_set hand, Suit trump, Neural_decision &d) {
+  d.options = 0;
+  for (Card_set h = hand; h; h &= h - 1) {
+    const Card c = card_at(__builtin_ctzll(h));
+    Neural_row &row = d.rows[d.options];
+    hand_features(hand, trump, row);
+    row.x[F_OPTION + relative_index(c, trump)] = 1;
+    row.x[F_DISCARD] = 1;
+    row.x[F_TRUMPS_HELD] = count(hand & suit_cards(trump, trump));
+    d.cards[d.options] = c;
+    d.pass[d.options] = false;
+    d.suits[d.options] = trump;
+    ++d.options;
+  }
+}
+
+// Next seat after seat that plays this hand
+static int next_playing(const Info_set &info, int seat) {
+  do {
+    seat = (seat + 1) % 4;
+  } while (info.sits_out(seat));
+  return seat;
+}
+
+static int seats_playing(const Info_set &info) {
+  int n = 0;
+  for (int seat = 0; seat < 4; ++seat) n += !info.sits_out(seat);
+  return n;
+}
+
+// A full trick stays in the Info_set until the next card is led
+static bool leading(const Info_set &info) {
+  return info.trick_size() == 0 || info.trick_size() == seats_playing(info);
+}
+
+void card_options(Card_set hand, const Info_set &info, int seat,
+                  Neural_decision &d) {
+  const Suit trump = info.get_trump();
+  const bool lead = leading(info);
+  const int n = lead ? 0 : info.trick_size();
+
+  // The card winning the trick so far, and its seat
+  int winner = 0, winner_seat = lead ? seat : info.trick_leader();
+  for (int i = 1, at = winner_seat; i < n; ++i) {
+    at = next_playing(info, at);
+    if (Card_less(info.trick_card(winner), info.trick_card(i),
+                  info.trick_card(0), trump)) {
+      winner = i;
+      winner_seat = at;
+    }
+  }
+
+  Card_set options = lead ? hand : legal_plays(hand, info.trick_card(0), trump);
+  d.options = 0;
+  for (; options; options &= options - 1) {
+    const Card c = card_at(__builtin_ctzll(options));
+    Neural_row &row = d.rows[d.options];
+    hand_features(hand, trump, row);
+    row.x[F_OPTION + relative_index(c, trump)] = 1;
+    row.x[lead ? F_LEAD : F_FOLLOW] = 1;
+    row.x[F_MAKERS] = info.get_maker() % 2 == seat % 2;
+    if (!lead) {
+      row.x[F_BEATS] = Card_less(info.trick_card(winner), c,
+                                 info.trick_card(0), trump);
+      row.x[F_PARTNER_WINNING] = winner_seat % 2 == seat % 2;
+    }
+    row.x[F_TRICKS_PLAYED] = count(info.played(seat));
+    row.x[F_TRUMPS_PLAYED] = count(info.played() & suit_cards(trump, trump));
+    row.x[F_TRICK_CARDS] = static_cast<uint8_t>(n);
+    d.cards[d.options] = c;
+    d.pass[d.options] = false;
+    d.suits[d.options] = trump;
+    ++d.options;
+  }
+}
+
+int seat_to_play(const Info_set &info, int known_seat) {
+  if (!leading(info)) {
+    int at = info.trick_leader();
+    for (int i = 1; i < info.trick_size(); ++i) at = next_playing(info, at);
+    return next_playing(info, at);
+  }
+  if (!info.played()) return next_playing(info, info.get_dealer());
+  return known_seat;
+}
+
+int best_option(const Mlp &mlp, const Neural_decision &d) {
+  assert(d.options > 0);
+  int32_t scores[Neural_decision::MAX_OPTIONS];
+  mlp_evaluate(mlp, d.rows, d.options, scores);
+  return static_cast<int>(max_element(scores, scores + d.options) - scores);
+}
+
+void neural_choose_batch(const Mlp &mlp, const Hand_state states[], int n,
+                         Card cards[]) {
+  // Decisions in groups small enough to keep on the stack
+  const int GROUP = 64, MAX_ROWS = GROUP * Neural_decision::MAX_OPTIONS;
+  Neural_row rows[MAX_ROWS];
+  Card options[MAX_ROWS];
+  int32_t scores[MAX_ROWS];
+  int first[GROUP + 1];  // first row of each decision
+  Neural_decision d;
+  for (int base = 0; base < n; base += GROUP) {
+    const int m = min(GROUP, n - base);
+    first[0] = 0;
+    for (int i = 0; i < m; ++i) {
+      const Hand_state &s = states[base + i];
+      card_options(s.hands[s.to_play], s.info, s.to_play, d);
+      copy(d.rows, d.rows + d.options, rows + first[i]);
+      copy(d.cards, d.cards + d.options, options + first[i]);
+      first[i + 1] = first[i] + d.options;
+    }
+    mlp_evaluate(mlp, rows, first[m], scores);
+    for (int i = 0; i < m; ++i) {
+      const int32_t *best =
+        max_element(scores + first[i], scores + first[i + 1]);
+      cards[base + i] = options[best - scores];
+    }
+  }
+}
+
+// Player
+
+class Neural : public Player {
+public:
+  Neural(const string &name_in, const Mlp &mlp_in)
+    : name(name_in), mlp(&mlp_in) {}
+
+  const string & get_name() const override { return name; }
+
+  void add_card(const Card &c) override {
+    assert(count(hand) < MAX_HAND_SIZE);
+    hand |= card_bit(c);
+  }
+
+  bool make_trump(const Card &upcard, bool is_dealer,
+                  int round, Suit &order_up_suit) const override {
+    Neural_decision d;
+    bid_options(hand, {upcard, is_dealer, round}, d);
+    const int best = best_option(*mlp, d);
+    if (d.pass[best]) return false;
+    order_up_suit = d.suits[best];
+    return true;
+  }
+
+  void add_and_discard(const Card &upcard) override {
+    assert(hand);
+    hand |= card_bit(upcard);
+    Neural_decision d;
+    discard_options(hand, upcard.get_suit(), d);
+    hand &= ~card_bit(d.cards[best_option(*mlp, d)]);
+  }
+
+  Card lead_card(Suit trump) override { return play(trump); }
+
+  Card play_card(const Card &led_card, Suit trump) override {
+    return play(trump);
+  }
+
+  void clear_hand() override { hand = 0; }
+
+  void watch(const Info_set &info_in) override { info = &info_in; }
+
+  Player * clone() const override { return new Neural(*this); }
+
+  void drop_card(const Card &c) override { hand &= ~card_bit(c); }
+
+private:
+  //REQUIRES the engine gave this player the hand's Info_set
+  Card play(Suit trump) {
+    assert(hand && info && info->get_trump() == trump);
+    Neural_decision d;
+    card_options(hand, *info, find_seat(), d);
+    const Card c = d.cards[best_option(*mlp, d)];
+    hand &= ~card_bit(c);
+    return c;
+  }
+
+  int find_seat() { return seat = seat_to_play(*info, seat); }
+
+  string name;
+  const Mlp *mlp;
+  const Info_set *info = nullptr;
+  Card_set hand = 0;
+  int seat = 0;
+};
+
+Player * Neural_factory(const string &name, const Mlp &mlp) {
+  return new Neural(name, mlp);
+}
@@ -0,0 +1,128 @@
+#ifndef NEURAL_HPP
+#define NEURAL_HPP
+/* Neural.hpp
+ *
+ * A learned strategy: every option of a decision (a suit to name, or pass;
+ * a card to discard, lead or play) is turned into a fixed vector of small
+ * integer features, scored by a small multilayer perceptron with 8-bit
+ * weights, and the best-scoring option is taken.
+ *
+ * The network has Mlp::INPUTS inputs, one hidden layer of Mlp::HIDDEN
+ * rectified units and one output.  Its arithmetic is integer only: inputs
+ * are unsigned bytes, weights signed bytes, sums 32-bit, and the hidden
+ * units are shifted back down to bytes, so every kernel gives exactly the
+ * same scores.  On x86 processors with AVX2 the kernels are AVX2, chosen at
+ * run time whatever SIMDFLAGS says; otherwise, or with -DBATCH_SCALAR, they
+ * are a portable loop.
+ *
+ * Options of many decisions, from many games, can be scored in one call,
+ * which is how neural_choose_batch() moves a whole batch of hands forward.
+ *
+ * Weights file layout, in host byte order: the 64-bit magic, then the
+ * 32-bit INPUTS, HIDDEN and shift, then w1, b1, w2 and b2 as in Mlp.
+ */
+
+#include "Card.hpp"
+#include "Game.hpp"
+#include "Info_set.hpp"
+#include "Player.hpp"
+#include <cstdint>
+#include <string>
+
+struct alignas(32) Mlp {
+  static const int INPUTS = 64;
+  static const int HIDDEN = 32;
+
+  std::int8_t w1[HIDDEN][INPUTS];   // input weights of each hidden unit
+  std::int32_t b1[HIDDEN];
+  std::int8_t w2[HIDDEN];           // output weight of each hidden unit
+  std::int32_t b2 = 0;
+  std::int32_t shift = 0;           // hidden unit = clamp(sum >> shift, 0, 127)
+};
+
+// The features of one option
+struct alignas(32) Neural_row {
+  std::uint8_t x[Mlp::INPUTS];
+};
+
+//MODIFIES mlp
+//EFFECTS Reads weights written by save_mlp.  Returns false if path cannot
+//  be read or does not hold weights of this shape.
+bool load_mlp(const std::string &path, Mlp &mlp);
+
+//EFFECTS Writes mlp to path and returns true if it was written
+bool save_mlp(const std::string &path, const Mlp &mlp);
+
+//MODIFIES scores
+//EFFECTS Scores rows[0..n) into scores[0..n)
+void mlp_evaluate(const Mlp &mlp, const Neural_row rows[], int n,
+                  std::int32_t scores[]);
+
+//EFFECTS As mlp_evaluate, one row at a time in plain C++; the kernels must
+//  agree with it exactly
+void mlp_evaluate_reference(const Mlp &mlp, const Neural_row rows[], int n,
+                            std::int32_t scores[]);
+
+//EFFECTS Returns the name of the kernels mlp_evaluate uses on this processor:
+//  "AVX2" or "scalar"
+const char * mlp_kernels();
+
+// The options of one decision with their features.  Bids have a suit, or
+// pass; every other option is a card.
+struct Neural_decision {
+  static const int MAX_OPTIONS = 6;
+  int options = 0;
+  Card cards[MAX_OPTIONS];
+  Suit suits[MAX_OPTIONS];
+  bool pass[MAX_OPTIONS];
+  Neural_row rows[MAX_OPTIONS];
+};
+
+// Where a bid is made, as Player::make_trump is told
+struct Bidding {
+  Card upcard;
+  bool is_dealer;
+  int round;      // 1 or 2
+};
+
+//MODIFIES d
+//EFFECTS Fills d with the bids open to a player holding hand: pass (except
+//  for the dealer in round 2, who is stuck) and each suit it may name
+void bid_options(Card_set hand, const Bidding &bid, Neural_decision &d);
+
+//REQUIRES hand holds six cards, the upcard among them
+//MODIFIES d
+//EFFECTS Fills d with each card the dealer may discard
+void discard_options(Card_set hand, Suit trump, Neural_decision &d);
+
+//REQUIRES info.trump_made(), hand is not empty and seat is next to play
+//MODIFIES d
+//EFFECTS Fills d with each card seat may lead or play from hand
+void card_options(Card_set hand, const Info_set &info, int seat,
+                  Neural_decision &d);
+
+//REQUIRES info.trump_made() and a card is to be played
+//EFFECTS Returns the seat to play, which players are not told: from the
+//  trick so far, or from the dealer before the first lead.  A seat leading
+//  a later trick also played in the first, so the seat it found then is
+//  passed in as known_seat and returned.
+int seat_to_play(const Info_set &info, int known_seat);
+
+//REQUIRES d.options > 0
+//EFFECTS Returns the index of the best-scoring option of d
+int best_option(const Mlp &mlp, const Neural_decision &d);
+
+//REQUIRES no state in states[0..n) is over
+//MODIFIES cards
+//EFFECTS Chooses the card each s.to_play plays next in states[0..n),
+//  scoring the options of all n decisions in one call
+void neural_choose_batch(const Mlp &mlp, const Hand_state states[], int n,
+                         Card cards[]);
+
+//REQUIRES mlp outlives the player
+//EFFECTS Returns a player that makes every decision with mlp, and can be
+//  cloned.  Player_factory(name, "Neural") uses the weights in the file
+//  neural.weights.
+Player * Neural_factory(const std::string &name, const Mlp &mlp);
+
+#endif // NEURAL_HPP
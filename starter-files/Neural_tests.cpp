@@ -0,0 +1,148 @@
+// Neural Tests
+#include "Neural.hpp"
+#include "Pack.hpp"
+#include "Rng.hpp"
+#include "unit_test_framework.hpp"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char *const WEIGHTS = "Neural_tests.weights";
+
+// Weights drawn at random over the whole range of each field
+static Mlp random_mlp(Rng &rng) {
+    Mlp mlp;
+    for (int h = 0; h < Mlp::HIDDEN; ++h) {
+        for (int i = 0; i < Mlp::INPUTS; ++i) {
+            mlp.w1[h][i] = static_cast<int8_t>(rng.below(255) - 127);
+        }
+        mlp.b1[h] = rng.below(20001) - 10000;
+        mlp.w2[h] = static_cast<int8_t>(rng.below(255) - 127);
+    }
+    mlp.b2 = rng.below(2001) - 1000;
+    mlp.shift = 6;
+    return mlp;
+}
+
+// Deals a hand for four seats, hearts made trump by seat 1
+static Hand_state deal_hand(Rng &rng) {
+    Pack pack;
+    pack.shuffle(rng);
+    Info_set info;
+    info.begin_hand(0, pack.deal_one());
+    info.make_trump(1, HEARTS, false);
+    Card_set hands[4] = {0, 0, 0, 0};
+    for (int seat = 0; seat < 4; ++seat) {
+        for (int j = 0; j < Player::MAX_HAND_SIZE; ++j) {
+            hands[seat] |= card_bit(pack.deal_one());
+        }
+    }
+    return start_play(info, hands);
+}
+
+TEST(test_mlp_kernels_match_reference) {
+    Rng rng(47);
+    for (int trial = 0; trial < 20; ++trial) {
+        Mlp mlp = random_mlp(rng);
+        const int n = 1 + trial * 7;
+        vector<Neural_row> rows(n);
+        for (Neural_row &row : rows) {
+            for (uint8_t &x : row.x) x = static_cast<uint8_t>(rng.below(8));
+        }
+        vector<int32_t> scores(n), expected(n);
+        mlp_evaluate(mlp, rows.data(), n, scores.data());
+        mlp_evaluate_reference(mlp, rows.data(), n, expected.data());
+        for (int i = 0; i < n; ++i) ASSERT_EQUAL(scores[i], expected[i]);
+    }
+}
+
+TEST(test_mlp_save_and_load) {
+    Rng rng(48);
+    Mlp mlp = random_mlp(rng), loaded;
+    ASSERT_TRUE(save_mlp(WEIGHTS, mlp));
+    ASSERT_TRUE(load_mlp(WEIGHTS, loaded));
+    ASSERT_EQUAL(loaded.shift, mlp.shift);
+    ASSERT_EQUAL(loaded.b2, mlp.b2);
+    for (int h = 0; h < Mlp::HIDDEN; ++h) {
+        ASSERT_EQUAL(loaded.b1[h], mlp.b1[h]);
+        ASSERT_EQUAL(loaded.w2[h], mlp.w2[h]);
+        for (int i = 0; i < Mlp::INPUTS; ++i) {
+            ASSERT_EQUAL(loaded.w1[h][i], mlp.w1[h][i]);
+        }
+    }
+    ASSERT_FALSE(load_mlp("no_such_file.weights", loaded));
+}
+
+TEST(test_bid_options) {
+    const Card upcard(JACK, CLUBS);
+    const Card_set hand = card_bit(Card(NINE, SPADES))
+        | card_bit(Card(ACE, HEARTS)) | card_bit(Card(TEN, CLUBS))
+        | card_bit(Card(KING, DIAMONDS)) | card_bit(Card(QUEEN, DIAMONDS));
+    Neural_decision d;
+
+    // Round 1: pass or order up clubs
+    bid_options(hand, {upcard, false, 1}, d);
+    ASSERT_EQUAL(d.options, 2);
+    ASSERT_TRUE(d.pass[0]);
+    ASSERT_FALSE(d.pass[1]);
+    ASSERT_EQUAL(d.suits[1], CLUBS);
+
+    // Round 2: pass or any suit but clubs
+    bid_options(hand, {upcard, false, 2}, d);
+    ASSERT_EQUAL(d.options, 4);
+    ASSERT_TRUE(d.pass[0]);
+    for (int i = 1; i < d.options; ++i) ASSERT_NOT_EQUAL(d.suits[i], CLUBS);
+
+    // The dealer is stuck in round 2 and may not pass
+    bid_options(hand, {upcard, true, 2}, d);
+    ASSERT_EQUAL(d.options, 3);
+    for (int i = 0; i < d.options; ++i) ASSERT_FALSE(d.pass[i]);
+}
+
+TEST(test_batched_choices_match_players) {
+    Rng rng(49);
+    const Mlp mlp = random_mlp(rng);
+    vector<Hand_state> batch;
+    vector<Hand_state> played;
+    for (int i = 0; i < 100; ++i) {
+        Hand_state s = deal_hand(rng);
+        batch.push_back(s);
+
+        // Played out by Neural players holding the same cards
+        unique_ptr<Player> owners[4];
+        Player *players[4];
+        for (int seat = 0; seat < 4; ++seat) {
+            owners[seat].reset(Neural_factory("Player", mlp));
+            players[seat] = owners[seat].get();
+            for (Card_set h = s.hands[seat]; h; h &= h - 1) {
+                int bit = __builtin_ctzll(h);
+                players[seat]->add_card(
+                    Card(static_cast<Rank>(bit / 4), static_cast<Suit>(bit % 4)));
+            }
+        }
+        play_out(s, players);
+        played.push_back(s);
+    }
+
+    // The same hands played in one batch, a card from each at a time
+    vector<Card> cards(batch.size());
+    while (!hand_over(batch[0])) {
+        neural_choose_batch(mlp, batch.data(), static_cast<int>(batch.size()),
+                            cards.data());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            ASSERT_TRUE(legal_cards(batch[i]) & card_bit(cards[i]));
+            apply_play(batch[i], cards[i]);
+        }
+    }
+    for (size_t i = 0; i < batch.size(); ++i) {
+        ASSERT_TRUE(hand_over(batch[i]));
+        ASSERT_EQUAL(batch[i].tricks[0], played[i].tricks[0]);
+        ASSERT_EQUAL(batch[i].tricks[1], played[i].tricks[1]);
+    }
+}
+
+TEST_MAIN()
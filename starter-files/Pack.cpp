@@ -25,6 +25,9 @@ Pack::Pack(std::istream &pack_input) : cards{}, next(0) {
     }
 }
 
+Pack::Pack(const std::array<Card, PACK_SIZE> &cards_in)
+  : cards(cards_in), next(0) {}
+
 Card Pack::deal_one() {
     assert(next < PACK_SIZE); // Ensure cards left to deal
     Card c = cards[next];
@@ -49,6 +52,21 @@ void Pack::shuffle() {
     next = 0; // Reset index after shuffle
 }
 
+void Pack::shuffle(Rng &rng) {
+    for (int i = PACK_SIZE - 1; i > 0; --i) {
+        std::swap(cards[i], cards[rng.below(i + 1)]);
+    }
+    next = 0;
+}
+
 bool Pack::empty() const {
     return next >= PACK_SIZE;
 }
+
+const std::array<Card, Pack::PACK_SIZE> & Pack::get_cards() const {
+    return cards;
+}
+
+int Pack::get_next() const {
+    return next;
+}
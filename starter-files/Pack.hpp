@@ -10,11 +10,14 @@
 
 
 #include "Card.hpp"
+#include "Rng.hpp"
 #include <array>
 #include <string>
 
 class Pack {
 public:
+  static const int PACK_SIZE = 24;
+
   // EFFECTS: Initializes the Pack to be in the following standard order:
   //          the cards of the lowest suit arranged from lowest rank to
   //          highest rank, followed by the cards of the next lowest suit
@@ -31,6 +34,10 @@ public:
   // NOTE: The pack is initially full, with no cards dealt.
   Pack(std::istream& pack_input);
 
+  // EFFECTS: Initializes Pack to hold cards_in in the given order.
+  // NOTE: The pack is initially full, with no cards dealt.
+  explicit Pack(const std::array<Card, PACK_SIZE> &cards_in);
+
   // REQUIRES: cards remain in the Pack
   // EFFECTS: Returns the next card in the pack and increments the next index
   Card deal_one();
@@ -43,11 +50,21 @@ public:
   //          https://en.wikipedia.org/wiki/In_shuffle.
   void shuffle();
 
+  // MODIFIES: rng
+  // EFFECTS: Puts the Pack in a uniformly random order drawn from rng
+  //          (Fisher-Yates) and resets the next index.
+  void shuffle(Rng &rng);
+
   // EFFECTS: returns true if there are no more cards left in the pack
   bool empty() const;
 
+  // EFFECTS: Returns all cards in the Pack's current order, dealt or not
+  const std::array<Card, PACK_SIZE> & get_cards() const;
+
+  // EFFECTS: Returns the index of the next card to be dealt
+  int get_next() const;
+
 private:
-  static const int PACK_SIZE = 24;
   std::array<Card, PACK_SIZE> cards;
   int next; //index of next card to be dealt
 };
@@ -0,0 +1,148 @@
+// PerfCounters.cpp
+#include "PerfCounters.hpp"
+#include <chrono>
+#include <iostream>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+PerfSample operator-(const PerfSample &lhs, const PerfSample &rhs) {
+  PerfSample d;
+  for (int e = 0; e < PerfSample::NUM_EVENTS; ++e) {
+    d.counts[e] = lhs.counts[e] - rhs.counts[e];
+  }
+  d.seconds = lhs.seconds - rhs.seconds;
+  return d;
+}
+
+PerfSample & operator+=(PerfSample &lhs, const PerfSample &rhs) {
+  for (int e = 0; e < PerfSample::NUM_EVENTS; ++e) {
+    lhs.counts[e] += rhs.counts[e];
+  }
+  lhs.seconds += rhs.seconds;
+  return lhs;
+}
+
+static double now_seconds() {
+  return chrono::duration<double>(
+    chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef __linux__
+
+// perf_event_attr type and config of each PerfSample::Event
+static const struct { uint32_t type; uint64_t config; } EVENTS[] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                       (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+};
+
+// Opens one event for this thread on any CPU, in group_fd's group (-1: as a
+// new group leader).  Returns the fd, or -1 if the event is unavailable.
+static int open_event(PerfSample::Event e, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = EVENTS[e].type;
+  attr.config = EVENTS[e].config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  long fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+  return static_cast<int>(fd);
+}
+
+PerfCounters::PerfCounters() : leader(-1), num_open(0) {
+  for (int e = 0; e < PerfSample::NUM_EVENTS; ++e) {
+    slot[e] = -1;
+    fds[e] = open_event(static_cast<PerfSample::Event>(e), leader);
+    if (fds[e] < 0) continue;
+    if (leader < 0) leader = fds[e];
+    slot[e] = num_open++;
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (int fd : fds) {
+    if (fd >= 0) close(fd);
+  }
+}
+
+PerfSample PerfCounters::read() const {
+  PerfSample s;
+  s.seconds = now_seconds();
+  if (leader < 0) return s;
+
+  // nr, time enabled, time running, then one value per open event
+  uint64_t buf[3 + PerfSample::NUM_EVENTS];
+  if (::read(leader, buf, sizeof(buf)) < static_cast<ssize_t>(
+        (3 + num_open) * sizeof(uint64_t))) {
+    return s;
+  }
+  // If the group had to share the PMU with others, scale up to the time it
+  // was enabled.
+  double scale = buf[2] > 0 && buf[2] < buf[1]
+                 ? static_cast<double>(buf[1]) / static_cast<double>(buf[2])
+                 : 1;
+  for (int e = 0; e < PerfSample::NUM_EVENTS; ++e) {
+    if (slot[e] >= 0) {
+      s.counts[e] = static_cast<uint64_t>(
+        static_cast<double>(buf[3 + slot[e]]) * scale);
+    }
+  }
+  return s;
+}
+
+#else
+
+PerfCounters::PerfCounters() : leader(-1), num_open(0) {
+  for (int e = 0; e < PerfSample::NUM_EVENTS; ++e) slot[e] = fds[e] = -1;
+}
+
+PerfCounters::~PerfCounters() {}
+
+PerfSample PerfCounters::read() const {
+  PerfSample s;
+  s.seconds = now_seconds();
+  return s;
+}
+
+#endif // __linux__
+
+bool PerfCounters::available(PerfSample::Event e) const {
+  return slot[e] >= 0;
+}
+
+void PerfCounters::print(ostream &os, const PerfSample &s,
+                         double units) const {
+  static const char *const NAMES[] = {
+    "cycles", "instructions", "branch misses", "L1D misses", "LLC misses"
+  };
+  if (units <= 0) units = 1;
+  os << s.seconds * 1e9 / units << " ns";
+  if (num_open == 0) {
+    os << ", counters unavailable";
+    return;
+  }
+  for (int e = 0; e < PerfSample::NUM_EVENTS; ++e) {
+    if (!available(static_cast<PerfSample::Event>(e))) continue;
+    os << ", " << static_cast<double>(s.counts[e]) / units << ' ' << NAMES[e];
+    if (e == PerfSample::INSTRUCTIONS && available(PerfSample::CYCLES) &&
+        s.counts[PerfSample::CYCLES] > 0) {
+      os << " (IPC " << static_cast<double>(s.counts[e]) /
+                        static_cast<double>(s.counts[PerfSample::CYCLES])
+         << ")";
+    }
+  }
+}
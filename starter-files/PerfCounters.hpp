@@ -0,0 +1,62 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+/* PerfCounters.hpp
+ *
+ * Hardware performance counters for the calling thread, read through Linux
+ * perf_event_open: cycles, instructions, branch misses, L1 data cache read
+ * misses and last-level cache misses, counted in user space only.  Events
+ * the kernel or the hardware will not provide (other systems, virtual
+ * machines, perf_event_paranoid) are left out; wall time is always there.
+ */
+
+#include <cstdint>
+#include <iosfwd>
+
+// Counts since the counters were opened, or the difference of two samples
+struct PerfSample {
+  enum Event { CYCLES, INSTRUCTIONS, BRANCH_MISSES, L1D_MISSES, LLC_MISSES,
+               NUM_EVENTS };
+  std::uint64_t counts[NUM_EVENTS] = {0, 0, 0, 0, 0};
+  double seconds = 0;
+};
+
+//EFFECTS Returns lhs - rhs, event by event
+PerfSample operator-(const PerfSample &lhs, const PerfSample &rhs);
+
+//MODIFIES lhs
+//EFFECTS Adds rhs to lhs, event by event
+PerfSample & operator+=(PerfSample &lhs, const PerfSample &rhs);
+
+class PerfCounters {
+public:
+  // EFFECTS: Opens and starts every event available to this thread
+  PerfCounters();
+
+  // EFFECTS: Closes the counters
+  ~PerfCounters();
+
+  // The counters are owned by exactly one PerfCounters
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters & operator=(const PerfCounters &) = delete;
+
+  // EFFECTS: Returns true if event e is being counted
+  bool available(PerfSample::Event e) const;
+
+  // EFFECTS: Returns the counts so far, with one system call for all events.
+  //          Events that are not available read as zero.
+  PerfSample read() const;
+
+  // EFFECTS: Prints s averaged over units, for example
+  //          "123 cycles, 210 instructions (IPC 1.71), 2.1 branch misses, ..."
+  //          Unavailable events are left out, or "counters unavailable"
+  //          is printed if none are.  Always prints the time per unit.
+  void print(std::ostream &os, const PerfSample &s, double units) const;
+
+private:
+  int leader;                          // group fd, -1 if nothing opened
+  int slot[PerfSample::NUM_EVENTS];    // position in a group read, -1: absent
+  int fds[PerfSample::NUM_EVENTS];
+  int num_open;
+};
+
+#endif // PERFCOUNTERS_HPP
@@ -1,147 +1,296 @@
 // Player.cpp
 #include "Player.hpp"
 #include "Card.hpp"
+#include "MappedFile.hpp"
+#include "Neural.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 #include <string>
+#include <string_view>
 
 using namespace std;
 
+// Summary of a hand of distinct cards, kept up to date as cards come and
+// go: one bitmask of ranks per suit.  Every question Simple asks (how many
+// cards of a suit, how many face-or-ace trumps, the highest and lowest card
+// of a suit) is a few bit operations for any trump, with no scan of the hand.
+class Hand_summary {
+public:
+  void add(const Card &c) {
+    assert(!contains(c));
+    ranks[c.get_suit()] |= bit(c.get_rank());
+  }
+
+  void remove(const Card &c) {
+    assert(contains(c));
+    ranks[c.get_suit()] &= ~bit(c.get_rank());
+  }
+
+  bool contains(const Card &c) const {
+    return ranks[c.get_suit()] & bit(c.get_rank());
+  }
+
+  int size() const {
+    int n = 0;
+    for (unsigned r : ranks) n += __builtin_popcount(r);
+    return n;
+  }
+
+  // Number of cards whose suit is s when trump is trump
+  int count(Suit s, Suit trump) const {
+    if (s == trump) return __builtin_popcount(ranks[s]) + has_left(trump);
+    return __builtin_popcount(plain(s, trump));
+  }
+
+  // Number of face or ace cards that are trump
+  int face_or_ace_trumps(Suit trump) const {
+    return __builtin_popcount(ranks[trump] & FACE_OR_ACE) + has_left(trump);
+  }
+
+  //REQUIRES count(s, trump) > 0
+  //EFFECTS Returns the highest card whose suit is s, by Card_less(trump)
+  Card highest(Suit s, Suit trump) const {
+    assert(count(s, trump) > 0);
+    if (s != trump) return Card(top(plain(s, trump)), s);
+    if (ranks[trump] & JACK_BIT) return Card(JACK, trump);
+    if (has_left(trump)) return Card(JACK, Suit_next(trump));
+    return Card(top(ranks[trump]), trump);
+  }
+
+  //REQUIRES count(s, trump) > 0
+  //EFFECTS Returns the lowest card whose suit is s, by Card_less(trump)
+  Card lowest(Suit s, Suit trump) const {
+    assert(count(s, trump) > 0);
+    if (s != trump) return Card(bottom(plain(s, trump)), s);
+    if (unsigned r = ranks[trump] & ~JACK_BIT) return Card(bottom(r), trump);
+    if (has_left(trump)) return Card(JACK, Suit_next(trump));
+    return Card(JACK, trump);
+  }
+
+  //EFFECTS Stores the highest non-trump card in c and returns true, or
+  //  returns false if every card is trump
+  bool highest_non_trump(Suit trump, Card &c) const {
+    int best = -1;
+    for (int s = SPADES; s <= DIAMONDS; ++s) {
+      unsigned r = s == trump ? 0 : plain(static_cast<Suit>(s), trump);
+      // Equal ranks go to the higher suit, as in operator<
+      if (r && top(r) >= best) {
+        best = top(r);
+        c = Card(top(r), static_cast<Suit>(s));
+      }
+    }
+    return best != -1;
+  }
+
+  //REQUIRES size() > 0
+  //EFFECTS Returns the lowest card by Card_less(trump)
+  Card lowest(Suit trump) const {
+    int best = ACE + 1;
+    Card c;
+    for (int s = SPADES; s <= DIAMONDS; ++s) {
+      unsigned r = s == trump ? 0 : plain(static_cast<Suit>(s), trump);
+      if (r && bottom(r) < best) {
+        best = bottom(r);
+        c = Card(bottom(r), static_cast<Suit>(s));
+      }
+    }
+    return best <= ACE ? c : lowest(trump, trump);
+  }
+
+private:
+  static const unsigned JACK_BIT = 1u << JACK;
+  static const unsigned FACE_OR_ACE =
+    1u << JACK | 1u << QUEEN | 1u << KING | 1u << ACE;
+
+  static unsigned bit(Rank r) { return 1u << r; }
+  static Rank top(unsigned r) { return static_cast<Rank>(31 - __builtin_clz(r)); }
+  static Rank bottom(unsigned r) { return static_cast<Rank>(__builtin_ctz(r)); }
+
+  bool has_left(Suit trump) const {
+    return ranks[Suit_next(trump)] & JACK_BIT;
+  }
+
+  // Ranks of the non-trump suit s, leaving out the left bower
+  unsigned plain(Suit s, Suit trump) const {
+    return s == Suit_next(trump) ? ranks[s] & ~JACK_BIT : ranks[s];
+  }
+
+  unsigned ranks[4] = {0, 0, 0, 0};   // bit r set: rank r is in the hand
+};
+
 // Simple player.
 class Simple : public Player {
 public:
-  explicit Simple(const string &name_in) : name(name_in) {}
+  explicit Simple(const string &name_in,
+                  const Simple_params &params_in = Simple_params())
+    : name(name_in), params(params_in) {}
 
   const string & get_name() const override { return name; }
 
   void add_card(const Card &c) override {
     assert(hand.size() < MAX_HAND_SIZE);
-    hand.push_back(c);
+    hand.add(c);
   }
 
+  // Order up with two face-or-ace trumps in round 1, or one of the next
+  // suit in round 2; the dealer is screwed in round 2.  params may change
+  // the counts and the suits considered.
   bool make_trump(const Card &upcard, bool is_dealer,
                   int round, Suit &order_up_suit) const override {
     assert(round == 1 || round == 2);
-
-    if (round == 1) {
-      // Count face-or-ace *trumps* relative to upcard.suit
-      Suit s = upcard.get_suit();
-      int count = 0;
-      for (const auto &c : hand) {
-        if (c.is_trump(s) && c.is_face_or_ace()) ++count;
-      }
-      if (count >= 2) {
-        order_up_suit = s;
-        return true;
-      }
-      return false;
-    } else {
-      Suit s = Suit_next(upcard.get_suit());
-      int count = 0;
-      for (const auto &c : hand) {
-        if (c.get_suit(s) == s && c.is_face_or_ace()) ++count;
-      }
-      if (count >= 1) {
-        order_up_suit = s;
-        return true;
-      }
-      // Screw the dealer
-      if (is_dealer) {
-        order_up_suit = s;
-        return true;
+    Suit s = (round == 1) ? upcard.get_suit() : Suit_next(upcard.get_suit());
+    if (round == 2 && params.name_any_suit) {
+      for (int t = SPADES; t <= DIAMONDS; ++t) {
+        if (t == upcard.get_suit()) continue;
+        Suit other = static_cast<Suit>(t);
+        if (hand.face_or_ace_trumps(other) > hand.face_or_ace_trumps(s)) {
+          s = other;
+        }
       }
-      return false;
     }
+    int needed = round == 1 ? params.order_up_round1 : params.order_up_round2;
+    if (hand.face_or_ace_trumps(s) >= needed || (round == 2 && is_dealer)) {
+      order_up_suit = s;
+      return true;
+    }
+    return false;
   }
 
   void add_and_discard(const Card &upcard) override {
     assert(hand.size() >= 1);
-    hand.push_back(upcard);
-    Suit trump = upcard.get_suit();
-    size_t low = 0;
-    for (size_t i = 1; i < hand.size(); ++i) {
-      if (Card_less(hand[i], hand[low], trump)) low = i;
-    }
-    hand.erase(hand.begin() + static_cast<long>(low));
+    hand.add(upcard);
+    hand.remove(hand.lowest(upcard.get_suit()));
   }
 
   Card lead_card(Suit trump) override {
-    assert(!hand.empty());
-    int best_nontrump = -1;
-    for (size_t i = 0; i < hand.size(); ++i) {
-      if (!hand[i].is_trump(trump)) {
-        if (best_nontrump == -1 ||
-            !Card_less(hand[i], hand[best_nontrump], trump)) {
-          best_nontrump = static_cast<int>(i);
-        }
-      }
+    assert(hand.size() > 0);
+    Card out;
+    if (hand.count(trump, trump) >= params.lead_trump_from
+        || !hand.highest_non_trump(trump, out)) {
+      out = hand.highest(trump, trump);
     }
-    int idx = -1;
-    if (best_nontrump != -1) {
-      idx = best_nontrump;
-    } else {
-      idx = 0;
-      for (size_t i = 1; i < hand.size(); ++i) {
-        if (!Card_less(hand[i], hand[idx], trump))
-          idx = static_cast<int>(i);
-      }
-    }
-    Card out = hand[static_cast<size_t>(idx)];
-    hand.erase(hand.begin() + idx);
+    hand.remove(out);
     return out;
   }
 
   Card play_card(const Card &led_card, Suit trump) override {
-    assert(!hand.empty());
-   
+    assert(hand.size() > 0);
     Suit led_suit = led_card.get_suit(trump);
-     vector<size_t> can_follow;
-     vector<size_t> trump_cards;
-    for (size_t i = 0; i < hand.size(); ++i) {
-      if (hand[i].get_suit(trump) == led_suit) can_follow.push_back(i);
-    }
-
-    size_t idx = 0;
-    if (!can_follow.empty()) {
-      idx = can_follow[0];
-      for (size_t k = 1; k < can_follow.size(); ++k) {
-        size_t i = can_follow[k];
-        if (!Card_less(hand[i], hand[idx], trump)) idx = i;
-      }
+    Card out;
+    if (hand.count(led_suit, trump) == 0) {
+      out = hand.lowest(trump);
+    } else if (params.follow_low) {
+      out = hand.lowest(led_suit, trump);
     } else {
-      for (size_t i = 1; i < hand.size(); ++i) {
-        if (Card_less(hand[i], hand[idx], trump)) idx = i;
-      }
+      out = hand.highest(led_suit, trump);
     }
-
-    Card out = hand[idx];
-    hand.erase(hand.begin() + static_cast<long>(idx));
+    hand.remove(out);
     return out;
   }
 
+  void clear_hand() override { hand = Hand_summary(); }
+
+  Player * clone() const override { return new Simple(*this); }
+
+  void drop_card(const Card &c) override { hand.remove(c); }
+
 private:
   string name;
-  vector<Card> hand;
+  Simple_params params;
+  Hand_summary hand;
 };
 
-//Human Player
-
-class Human : public Player {
+// Players whose decisions come from outside the program.  The hand is kept
+// sorted by operator< and every card is chosen by its index in that order.
+// It is a fixed array, so copying a player copies no heap memory but its
+// name.
+class Indexed_player : public Player {
 public:
-  explicit Human(const string &name_in) : name(name_in) {}
+  explicit Indexed_player(const string &name_in) : name(name_in) {}
 
   const string & get_name() const override { return name; }
 
   void add_card(const Card &c) override {
-    hand.push_back(c);
-    sort(hand.begin(), hand.end()); // ascending
+    assert(hand_size < MAX_HAND_SIZE);
+    int i = hand_size++;
+    for (; i > 0 && c < hand[i - 1]; --i) hand[i] = hand[i - 1]; // ascending
+    hand[i] = c;
   }
 
   bool make_trump(const Card &upcard, bool is_dealer,
                   int round, Suit &order_up_suit) const override {
-    (void)upcard; (void)is_dealer;
+    (void)upcard; (void)is_dealer; (void)round;
+    return choose_suit(order_up_suit);
+  }
+
+  void add_and_discard(const Card &upcard) override {
+    int choice = choose_discard();
+
+    // Hand is assumed valid
+    if (choice != -1) {
+      // Replace the chosen card with the upcard
+      remove_card(choice);
+      add_card(upcard);
+    }
+  }
+
+  Card lead_card(Suit trump) override {
+    (void)trump; // unused parameter
+    return remove_card(choose_card());
+  }
+
+  Card play_card(const Card &led_card, Suit trump) override {
+    (void)led_card; // unused parameter
+    (void)trump;
+    return remove_card(choose_card());
+  }
+
+  void clear_hand() override { hand_size = 0; }
+
+  void drop_card(const Card &c) override {
+    remove_card(static_cast<int>(find(hand, hand + hand_size, c) - hand));
+  }
+
+protected:
+  //EFFECTS Returns false to pass, or true and sets suit to the suit named
+  virtual bool choose_suit(Suit &suit) const = 0;
+
+  //EFFECTS Returns the index of the card to discard, or -1 for the upcard
+  virtual int choose_discard() = 0;
+
+  //EFFECTS Returns the index of the card to lead or play
+  virtual int choose_card() = 0;
+
+  string name;
+  Card hand[MAX_HAND_SIZE]; //first hand_size cards, kept sorted by ascending
+  int hand_size = 0;
+
+private:
+  Card remove_card(int choice) {
+    assert(choice >= 0 && choice < hand_size);
+    Card out = hand[choice];
+    copy(hand + choice + 1, hand + hand_size, hand + choice);
+    --hand_size;
+    return out;
+  }
+};
+
+//Human Player
+
+// A Human is never cloned, since a copy would ask the user again for each
+// decision it made.
+class Human : public Indexed_player {
+public:
+  explicit Human(const string &name_in) : Indexed_player(name_in) {}
+
+protected:
+  bool choose_suit(Suit &suit) const override {
     print_hand();
     cout << "Human player " << name
          << ", please enter a suit, or \"pass\":\n";
@@ -152,79 +301,160 @@ public:
     if (decision == "pass") {
       return false;
     }
-    order_up_suit = string_to_suit(decision);
+    suit = string_to_suit(decision);
     return true;
   }
 
-  void add_and_discard(const Card &upcard) override {
+  int choose_discard() override {
     // Show ONLY the current 5-card hand
     print_hand();
     cout << "Discard upcard: [-1]\n";
     cout << "Human player " << name
          << ", please select a card to discard:\n";
-  
-    int choice = 0;
-    cin >> choice;
-  
-    // Hand is assumed valid
-    if (choice != -1) {
-      assert(choice >= 0 && static_cast<size_t>(choice) < hand.size());
-      // Replace the chosen card with the upcard
-      hand[static_cast<size_t>(choice)] = upcard;
-      std::sort(hand.begin(), hand.end()); // keep invariant
-    }
-  }
-  
 
-  Card lead_card(Suit trump) override {
-    (void)trump; // unused parameter
-    print_hand();
-    cout << "Human player " << name << ", please select a card:\n";
     int choice = 0;
     cin >> choice;
-    assert(choice >= 0 && static_cast<size_t>(choice) < hand.size());
-    Card out = hand[static_cast<size_t>(choice)];
-    hand.erase(hand.begin() + choice);
-    return out;
+    return choice;
   }
-  
-  Card play_card(const Card &led_card, Suit trump) override {
-    (void)led_card; // unused parameter
-    (void)trump;
+
+  int choose_card() override {
     print_hand();
     cout << "Human player " << name << ", please select a card:\n";
     int choice = 0;
     cin >> choice;
-    assert(choice >= 0 && static_cast<size_t>(choice) < hand.size());
-    Card out = hand[static_cast<size_t>(choice)];
-    hand.erase(hand.begin() + choice);
-    return out;
+    return choice;
   }
-  
 
 private:
   void print_hand() const {
     // Hand must be printed in ascending order as defined by operator<
     // We keep it sorted on every mutation, so just print:
-    for (size_t i = 0; i < hand.size(); ++i) {
+    for (int i = 0; i < hand_size; ++i) {
       cout << "Human player " << name << "'s hand: "
            << "[" << i << "] " << hand[i] << "\n";
     }
   }
+};
 
-  string name;
-  vector<Card> hand; //keep sorted by ascending
+// Scripted player: a Human without prompts whose answers are read from a
+// shared, read-only buffer instead of cin.  A script that runs out or holds
+// a decision that cannot be played throws runtime_error, which the game
+// reports as an error.
+
+class Scripted : public Indexed_player {
+public:
+  Scripted(const string &name_in, const char *script, size_t len)
+    : Indexed_player(name_in), pos(script), end(script + len) {}
+
+  // Maps NAME.script and keeps the mapping alive as long as the player.
+  //REQUIRES the script could be opened
+  Scripted(const string &name_in, const shared_ptr<MappedFile> &file_in)
+    : Indexed_player(name_in), file(file_in),
+      pos(file->data()), end(file->data() + file->size()) {
+    assert(file->is_open());
+  }
+
+  // The clone reads on from the same point of the same script
+  Player * clone() const override { return new Scripted(*this); }
+
+protected:
+  bool choose_suit(Suit &suit) const override {
+    string_view decision = next_token();
+    if (decision == "pass") {
+      return false;
+    }
+    static const char *const SUIT_NAMES[] = {
+      "Spades", "Hearts", "Clubs", "Diamonds",
+    };
+    for (int s = SPADES; s <= DIAMONDS; ++s) {
+      if (decision == SUIT_NAMES[s]) {
+        suit = static_cast<Suit>(s);
+        return true;
+      }
+    }
+    bad_decision(decision);
+  }
+
+  // -1 discards the upcard
+  int choose_discard() override { return next_index(-1); }
+
+  int choose_card() override { return next_index(0); }
+
+private:
+  //EFFECTS Returns the next whitespace-separated token and consumes it, or
+  //  throws runtime_error if the script has run out of decisions
+  string_view next_token() const {
+    while (pos != end && isspace(static_cast<unsigned char>(*pos))) ++pos;
+    const char *first = pos;
+    while (pos != end && !isspace(static_cast<unsigned char>(*pos))) ++pos;
+    if (first == pos) {
+      throw runtime_error("Scripted player " + name
+                          + " ran out of decisions");
+    }
+    return string_view(first, static_cast<size_t>(pos - first));
+  }
+
+  //EFFECTS Returns the next token as an index into the hand, at least
+  //  lowest, or throws runtime_error if it is not one
+  int next_index(int lowest) const {
+    string_view tok = next_token();
+    bool negative = tok.front() == '-';
+    if (tok.size() == (negative ? 2 : 1)
+        && isdigit(static_cast<unsigned char>(tok.back()))) {
+      int value = negative ? -(tok.back() - '0') : tok.back() - '0';
+      if (value >= lowest && value < hand_size) return value;
+    }
+    bad_decision(tok);
+  }
+
+  [[noreturn]] void bad_decision(string_view tok) const {
+    throw runtime_error("Scripted player " + name + " cannot play \""
+                        + string(tok) + "\"");
+  }
+
+  shared_ptr<MappedFile> file; // null when the script is borrowed
+  mutable const char *pos;     // make_trump is const but consumes a decision
+  const char *end;
 };
 
 // Player factory. 
 
+// Weights of every "Neural" player, read once.  Exits if they cannot be.
+static const Mlp & neural_weights() {
+  static Mlp mlp;
+  static const bool loaded = load_mlp("neural.weights", mlp);
+  if (!loaded) {
+    cout << "Error opening neural.weights" << endl;
+    exit(1);
+  }
+  return mlp;
+}
+
 Player * Player_factory(const std::string &name, const std::string &strategy) {
   if (strategy == "Simple") return new Simple(name);
   if (strategy == "Human")  return new Human(name);
+  if (strategy == "Scripted") {
+    auto file = make_shared<MappedFile>(name + ".script");
+    if (!file->is_open()) {
+      cout << "Error opening " << name << ".script" << endl;
+      exit(1);
+    }
+    return new Scripted(name, file);
+  }
+  if (strategy == "Neural") return Neural_factory(name, neural_weights());
   assert(false);
   return nullptr;
 }
 
+Player * Simple_factory(const std::string &name, const Simple_params &params) {
+  return new Simple(name, params);
+}
+
+Player * Scripted_factory(const std::string &name,
+                          const char *script, std::size_t len) {
+  return new Scripted(name, script, len);
+}
+
 std::ostream & operator<<(std::ostream &os, const Player &p) {
   os << p.get_name();
   return os;
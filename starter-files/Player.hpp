@@ -11,6 +11,8 @@
 
 
 #include "Card.hpp"
+#include "Info_set.hpp"
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -46,6 +48,40 @@ class Player {
   //  The card is removed from the player's hand.
   virtual Card play_card(const Card &led_card, Suit trump) = 0;
 
+  //MODIFIES Player
+  //EFFECTS  Discards the rest of the hand unplayed, when the player sits the
+  //  hand out or the hand is thrown in.  Only called under rules that allow
+  //  going alone or do not stick the dealer, so players that play only the
+  //  standard rules need not override it; by default it does nothing.
+  virtual void clear_hand() {}
+
+  //REQUIRES Player just made trump
+  //EFFECTS Returns true to play the hand without its partner.  Only asked
+  //  under rules that allow going alone.
+  virtual bool go_alone(Suit trump) const { return false; }
+
+  //REQUIRES An opponent is going alone
+  //EFFECTS Returns true to defend without its partner.  Only asked under
+  //  rules that allow defending alone.
+  virtual bool defend_alone(Suit trump) const { return false; }
+
+  //EFFECTS Called by the engine before each hand is dealt with the public
+  //  history of that hand, which the engine keeps up to date as the hand is
+  //  played.  Players that do not use history need not override this.
+  virtual void watch(const Info_set &info) {}
+
+  //EFFECTS Returns a new player in exactly this player's state, hand
+  //  included, whose future decisions are the ones this player would make;
+  //  or null if the player cannot be copied.  The caller deletes the copy.
+  //  A clone still watches the Info_set this player watched until it is
+  //  given another.
+  virtual Player * clone() const { return nullptr; }
+
+  //REQUIRES Player has c, and clone() does not return null
+  //EFFECTS  Removes c from the hand without playing it, so that a clone can
+  //  follow a forked hand in which c was played for it
+  virtual void drop_card(const Card &c) {}
+
   // Maximum number of cards in a player's hand
   static const int MAX_HAND_SIZE = 5;
 
@@ -58,8 +94,46 @@ class Player {
 //To create an object that won't go out of scope when the function returns,
 //use "return new Simple(name)" or "return new Human(name)"
 //Don't forget to call "delete" on each Player* after the game is over
+//A "Scripted" player replays its decisions from the file NAME.script; see
+//Scripted_factory for the format.  A "Neural" player plays with the weights
+//in the file neural.weights; see Neural.hpp.
 Player * Player_factory(const std::string &name, const std::string &strategy);
 
+// The choices of the "Simple" strategy that a tuner may vary.  The defaults
+// are the strategy Player_factory makes.
+struct Simple_params {
+  // Face-or-ace trumps needed to order up in round 1 (of the upcard's suit)
+  // and in round 2 (of the suit named)
+  int order_up_round1 = 2;
+  int order_up_round2 = 1;
+
+  // Round 2 considers every suit but the upcard's, naming the one with the
+  // most face-or-ace trumps, instead of only the next suit
+  bool name_any_suit = false;
+
+  // Trumps held from which the highest trump is led instead of the highest
+  // non-trump; above MAX_HAND_SIZE, never
+  int lead_trump_from = 6;
+
+  // Following suit, play the lowest card of the suit instead of the highest
+  bool follow_low = false;
+};
+
+//EFFECTS: Returns a pointer to a "Simple" player that decides as params say
+Player * Simple_factory(const std::string &name, const Simple_params &params);
+
+//REQUIRES script[0..len) holds whitespace-separated decisions, in the order
+//  the player is asked for them: a suit or "pass" for make_trump, a hand
+//  index or -1 (discard the upcard) for add_and_discard, and a hand index for
+//  lead_card and play_card.  Indices refer to the hand sorted by operator<,
+//  exactly as a Human player sees it.  The bytes must outlive the player and
+//  are never written, so one script may back any number of players.
+//EFFECTS: Returns a pointer to a player that replays script without printing.
+//  When the script runs out, or holds a decision that is not a suit, "pass"
+//  or an index into the hand, the player throws std::runtime_error.
+Player * Scripted_factory(const std::string &name,
+                          const char *script, std::size_t len);
+
 //EFFECTS: Prints player's name to os
 std::ostream & operator<<(std::ostream &os, const Player &p);
 
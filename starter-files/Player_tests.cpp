@@ -3,6 +3,8 @@
 #include "unit_test_framework.hpp"
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 using namespace std;
 
@@ -272,4 +274,129 @@ TEST(test_card_get_suit_maps_left_bower) {
     ASSERT_TRUE(jd.is_left_bower(HEARTS));
 }
 
+// SIMPLE PARAMETERS ---
+
+TEST(test_simple_params_change_decisions) {
+    Simple_params params;
+    params.order_up_round2 = 2;
+    params.name_any_suit = true;
+    params.lead_trump_from = 2;
+    params.follow_low = true;
+    Player* tuned = Simple_factory("Tuned", params);
+    Player* plain = Simple_factory("Plain", Simple_params());
+    const Card hand[] = {Card(KING, SPADES), Card(ACE, SPADES),
+                         Card(NINE, HEARTS), Card(KING, HEARTS),
+                         Card(QUEEN, DIAMONDS)};
+    for (const Card &c : hand) {
+        tuned->add_card(c);
+        plain->add_card(c);
+    }
+
+    // The tuned player needs two trumps, but may name any suit
+    Suit order_up = HEARTS;
+    ASSERT_FALSE(plain->make_trump(Card(TEN, SPADES), false, 2, order_up));
+    ASSERT_FALSE(tuned->make_trump(Card(TEN, SPADES), false, 2, order_up));
+    ASSERT_TRUE(tuned->make_trump(Card(TEN, HEARTS), false, 2, order_up));
+    ASSERT_EQUAL(order_up, SPADES);
+
+    // Two trumps are enough to lead one; following, play low
+    ASSERT_EQUAL(plain->lead_card(SPADES), Card(KING, HEARTS));
+    ASSERT_EQUAL(tuned->lead_card(SPADES), Card(ACE, SPADES));
+    ASSERT_EQUAL(tuned->play_card(Card(ACE, HEARTS), SPADES),
+                 Card(NINE, HEARTS));
+    delete tuned;
+    delete plain;
+}
+
+// SCRIPTED PLAYER ---
+
+TEST(test_scripted_replays_decisions) {
+    const string script = "pass\nDiamonds\n-1 2\n0\n";
+    Player* sam = Scripted_factory("Sam", script.data(), script.size());
+    sam->add_card(Card(KING, SPADES));
+    sam->add_card(Card(NINE, HEARTS));
+    sam->add_card(Card(ACE, CLUBS));
+
+    Suit order_up = SPADES;
+    ASSERT_FALSE(sam->make_trump(Card(TEN, HEARTS), false, 1, order_up));
+    ASSERT_TRUE(sam->make_trump(Card(TEN, HEARTS), false, 2, order_up));
+    ASSERT_EQUAL(order_up, DIAMONDS);
+
+    // -1 keeps the hand; indices refer to the sorted hand
+    sam->add_and_discard(Card(TEN, HEARTS));
+    ASSERT_EQUAL(sam->lead_card(DIAMONDS), Card(ACE, CLUBS));
+    ASSERT_EQUAL(sam->play_card(Card(NINE, SPADES), DIAMONDS),
+                 Card(NINE, HEARTS));
+    delete sam;
+}
+
+TEST(test_scripted_players_share_script) {
+    const string script = "1";
+    Player* a = Scripted_factory("A", script.data(), script.size());
+    Player* b = Scripted_factory("B", script.data(), script.size());
+    a->add_card(Card(NINE, SPADES));
+    a->add_card(Card(TEN, SPADES));
+    b->add_card(Card(QUEEN, HEARTS));
+    b->add_card(Card(KING, HEARTS));
+    ASSERT_EQUAL(a->lead_card(SPADES), Card(TEN, SPADES));
+    ASSERT_EQUAL(b->lead_card(SPADES), Card(KING, HEARTS));
+    delete a;
+    delete b;
+}
+
+TEST(test_scripted_bad_script_throws) {
+    const string script = "Diamonds 7 x";
+    Player* sam = Scripted_factory("Sam", script.data(), script.size());
+    sam->add_card(Card(KING, SPADES));
+    Suit order_up = SPADES;
+    ASSERT_TRUE(sam->make_trump(Card(TEN, HEARTS), false, 2, order_up));
+    // Not in the hand, not a number, then nothing left
+    for (int i = 0; i < 3; ++i) {
+        bool thrown = false;
+        try {
+            sam->lead_card(SPADES);
+        } catch (const runtime_error &) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown);
+    }
+    delete sam;
+}
+
+// BENCHMARKS --- run with ./Player_tests.exe --bench
+
+static Player* simple_with_hand() {
+    Player* p = Player_factory("Bench", "Simple");
+    p->add_card(Card(NINE, SPADES));
+    p->add_card(Card(JACK, HEARTS));
+    p->add_card(Card(QUEEN, DIAMONDS));
+    p->add_card(Card(ACE, CLUBS));
+    p->add_card(Card(KING, HEARTS));
+    return p;
+}
+
+BENCH(bench_simple_make_trump) {
+    const Card upcards[] = {Card(TEN, HEARTS), Card(NINE, SPADES),
+                            Card(ACE, DIAMONDS), Card(KING, CLUBS)};
+    Player* p = simple_with_hand();
+    Suit order_up = SPADES;
+    for (long i = 0; i < bench.iterations; ++i) {
+        unit_test_framework::do_not_optimize(
+            p->make_trump(upcards[i & 3], i & 4, 1 + (i >> 3 & 1), order_up));
+    }
+    delete p;
+}
+
+// Each card played is given back, so the hand stays full
+BENCH(bench_simple_play_card) {
+    const Card led[] = {Card(TEN, HEARTS), Card(NINE, CLUBS),
+                        Card(ACE, DIAMONDS), Card(KING, SPADES)};
+    Player* p = simple_with_hand();
+    for (long i = 0; i < bench.iterations; ++i) {
+        Card c = p->play_card(led[i & 3], static_cast<Suit>(i >> 2 & 3));
+        p->add_card(c);
+    }
+    delete p;
+}
+
 TEST_MAIN()
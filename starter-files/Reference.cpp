@@ -0,0 +1,318 @@
+// Reference.cpp
+#include "Reference.hpp"
+#include "Pack.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <vector>
+
+using namespace std;
+
+namespace reference {
+
+// Card predicates.  Only a card's rank and suit are read from Card; every
+// rule is worked out here, so that changes to the helpers in Card.hpp are
+// checked rather than copied.
+
+// The other suit of the same color
+static Suit suit_next(Suit suit) {
+  switch (suit) {
+  case SPADES: return CLUBS;
+  case CLUBS: return SPADES;
+  case HEARTS: return DIAMONDS;
+  case DIAMONDS: return HEARTS;
+  }
+  assert(false);
+  return suit;
+}
+
+static bool is_right_bower(const Card &c, Suit trump) {
+  return c.get_rank() == JACK && c.get_suit() == trump;
+}
+
+static bool is_left_bower(const Card &c, Suit trump) {
+  return c.get_rank() == JACK && c.get_suit() == suit_next(trump);
+}
+
+// The suit c counts as, the left bower being trump
+static Suit suit_of(const Card &c, Suit trump) {
+  return is_left_bower(c, trump) ? trump : c.get_suit();
+}
+
+static bool is_trump(const Card &c, Suit trump) {
+  return suit_of(c, trump) == trump;
+}
+
+static bool is_face_or_ace(const Card &c) {
+  return c.get_rank() >= JACK;
+}
+
+// Card order
+
+// Position of a card in the trump order of the spec: right bower, left
+// bower, the other trumps by rank, then the led suit by rank (when a card
+// was led), then every other card by rank.  Equal ranks fall back to the
+// natural suit order, as operator< does.
+static int strength(const Card &c, Suit trump, const Card *led_card) {
+  if (is_right_bower(c, trump)) return 1001;
+  if (is_left_bower(c, trump)) return 1000;
+
+  int natural = c.get_rank() * 4 + c.get_suit();
+  if (c.get_suit() == trump) return 800 + natural;
+  if (led_card) {
+    Suit led_suit = suit_of(*led_card, trump);
+    if (c.get_suit() == led_suit) return 600 + natural;
+  }
+  return natural;
+}
+
+// Card_less without a led card.  (Card_less itself is ambiguous inside this
+// namespace, since argument-dependent lookup also finds ::Card_less.)
+static bool lower(const Card &a, const Card &b, Suit trump) {
+  return strength(a, trump, nullptr) < strength(b, trump, nullptr);
+}
+
+bool Card_less(const Card &a, const Card &b, Suit trump) {
+  return lower(a, b, trump);
+}
+
+bool Card_less(const Card &a, const Card &b, const Card &led_card,
+               Suit trump) {
+  return strength(a, trump, &led_card) < strength(b, trump, &led_card);
+}
+
+int trick_winner(const Card cards[], Suit trump) {
+  int winner = 0;
+  for (int i = 1; i < 4; ++i) {
+    if (strength(cards[winner], trump, cards) <
+        strength(cards[i], trump, cards)) {
+      winner = i;
+    }
+  }
+  return winner;
+}
+
+// Simple player
+
+class Simple : public Player {
+public:
+  explicit Simple(const string &name_in) : name(name_in) {}
+
+  const string & get_name() const override { return name; }
+
+  void add_card(const Card &c) override { hand.push_back(c); }
+
+  // Round 1: order up the upcard's suit with two or more face or ace
+  // trumps.  Round 2: order up the next suit with one or more; the dealer
+  // must order it up.
+  bool make_trump(const Card &upcard, bool is_dealer,
+                  int round, Suit &order_up_suit) const override {
+    Suit s = (round == 1) ? upcard.get_suit() : suit_next(upcard.get_suit());
+    int good = 0;
+    for (const Card &c : hand) {
+      if (is_trump(c, s) && is_face_or_ace(c)) ++good;
+    }
+    if (good >= 3 - round || (round == 2 && is_dealer)) {
+      order_up_suit = s;
+      return true;
+    }
+    return false;
+  }
+
+  // Pick up the upcard, then discard the lowest card.
+  void add_and_discard(const Card &upcard) override {
+    hand.push_back(upcard);
+    take(lowest(upcard.get_suit()));
+  }
+
+  // Lead the highest non-trump card, or the highest trump if all are trump.
+  Card lead_card(Suit trump) override {
+    int best = -1;
+    for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+      if (is_trump(hand[i], trump)) continue;
+      if (best == -1 || lower(hand[best], hand[i], trump)) best = i;
+    }
+    return take(best == -1 ? highest(trump) : best);
+  }
+
+  // Follow suit with the highest card possible, else play the lowest card.
+  Card play_card(const Card &led_card, Suit trump) override {
+    Suit led_suit = suit_of(led_card, trump);
+    int best = -1;
+    for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+      if (suit_of(hand[i], trump) != led_suit) continue;
+      if (best == -1 || lower(hand[best], hand[i], trump)) best = i;
+    }
+    return take(best == -1 ? lowest(trump) : best);
+  }
+
+private:
+  int highest(Suit trump) const {
+    int best = 0;
+    for (int i = 1; i < static_cast<int>(hand.size()); ++i) {
+      if (lower(hand[best], hand[i], trump)) best = i;
+    }
+    return best;
+  }
+
+  int lowest(Suit trump) const {
+    int best = 0;
+    for (int i = 1; i < static_cast<int>(hand.size()); ++i) {
+      if (lower(hand[i], hand[best], trump)) best = i;
+    }
+    return best;
+  }
+
+  Card take(int i) {
+    assert(0 <= i && i < static_cast<int>(hand.size()));
+    Card c = hand[i];
+    hand.erase(hand.begin() + i);
+    return c;
+  }
+
+  string name;
+  vector<Card> hand;
+};
+
+Player * Simple_factory(const string &name) {
+  return new Simple(name);
+}
+
+// Pack.  Only the order of the game's pack is read from Pack; shuffling
+// and dealing are done here.
+
+class Deck {
+public:
+  explicit Deck(const Pack &pack)
+    : cards(pack.get_cards().begin(), pack.get_cards().end()) {}
+
+  // Seven in shuffles: the pack is cut in half and the halves interleaved,
+  // starting with the second half
+  void shuffle() {
+    const int half = static_cast<int>(cards.size()) / 2;
+    for (int k = 0; k < 7; ++k) {
+      vector<Card> old = cards;
+      for (int i = 0; i < half; ++i) {
+        cards[2 * i] = old[half + i];
+        cards[2 * i + 1] = old[i];
+      }
+    }
+    next = 0;
+  }
+
+  void reset() { next = 0; }
+
+  Card deal_one() {
+    assert(next < static_cast<int>(cards.size()));
+    return cards[next++];
+  }
+
+  //MODIFIES pack
+  //EFFECTS Leaves pack in this deck's order with as many cards dealt
+  void copy_to(Pack &pack) const {
+    array<Card, Pack::PACK_SIZE> order;
+    copy(cards.begin(), cards.end(), order.begin());
+    pack = Pack(order);
+    for (int i = 0; i < next; ++i) pack.deal_one();
+  }
+
+private:
+  vector<Card> cards;
+  int next = 0;
+};
+
+// Game
+
+static void deal(Deck &deck, int dealer, Player *const players[]) {
+  // Batches of 3-2-3-2 then 2-3-2-3 cards, starting left of the dealer
+  static const int BATCHES[8] = {3, 2, 3, 2, 2, 3, 2, 3};
+  for (int i = 0; i < 8; ++i) {
+    Player *p = players[(dealer + 1 + i) % 4];
+    for (int j = 0; j < BATCHES[i]; ++j) {
+      p->add_card(deck.deal_one());
+    }
+  }
+}
+
+static void make_trump(Player *const players[], Hand_result &hr,
+                       Game_observer &obs) {
+  for (int round = 1; round <= 2; ++round) {
+    for (int i = 1; i <= 4; ++i) {
+      int seat = (hr.dealer + i) % 4;
+      Suit s = SPADES;
+      if (players[seat]->make_trump(hr.upcard, seat == hr.dealer, round, s)) {
+        hr.trump = (round == 1) ? hr.upcard.get_suit() : s;
+        hr.maker = seat;
+        hr.round = round;
+        obs.order_up(seat, hr.trump);
+        if (round == 1) players[hr.dealer]->add_and_discard(hr.upcard);
+        return;
+      }
+      obs.pass(seat);
+    }
+  }
+  // Nobody ordered up: the dealer is stuck with the next suit
+  hr.trump = suit_next(hr.upcard.get_suit());
+  hr.maker = hr.dealer;
+  hr.round = 3;
+  obs.order_up(hr.dealer, hr.trump);
+}
+
+static void play_tricks(Player *const players[], Hand_result &hr,
+                        Game_observer &obs) {
+  int leader = (hr.dealer + 1) % 4;
+  for (int trick = 0; trick < 5; ++trick) {
+    Card cards[4];
+    cards[0] = players[leader]->lead_card(hr.trump);
+    obs.card_led(leader, cards[0]);
+    for (int i = 1; i < 4; ++i) {
+      cards[i] = players[(leader + i) % 4]->play_card(cards[0], hr.trump);
+      obs.card_played((leader + i) % 4, cards[i]);
+    }
+    leader = (leader + reference::trick_winner(cards, hr.trump)) % 4;
+    obs.trick_won(leader);
+    ++hr.tricks[leader % 2];
+  }
+}
+
+int play_game(Game_state &state, Player *const players[],
+              const Game_config &config, Game_observer &obs) {
+  const int target = config.points_to_win;
+  Deck deck(state.pack);
+  while (state.score[0] < target && state.score[1] < target) {
+    Hand_result hr;
+    hr.dealer = state.dealer;
+    obs.hand_begin(state.hand, state.dealer);
+    if (config.shuffle) {
+      deck.shuffle();
+    } else {
+      deck.reset();
+    }
+    deal(deck, state.dealer, players);
+    hr.upcard = deck.deal_one();
+    obs.upcard(hr.upcard);
+    make_trump(players, hr, obs);
+    obs.bidding_end();
+    play_tricks(players, hr, obs);
+
+    // Makers score 1 for 3-4 tricks and 2 for a march; defenders score 2
+    // for a euchre.
+    int makers = hr.maker % 2;
+    hr.march = hr.tricks[makers] == 5;
+    hr.euchred = hr.tricks[makers] < 3;
+    hr.points[hr.euchred ? 1 - makers : makers] =
+      (hr.march || hr.euchred) ? 2 : 1;
+    state.score[0] += hr.points[0];
+    state.score[1] += hr.points[1];
+    obs.hand_end(hr, state);
+
+    state.dealer = (state.dealer + 1) % 4;
+    ++state.hand;
+  }
+  deck.copy_to(state.pack);
+  int winner = state.score[0] >= target ? 0 : 1;
+  obs.game_end(winner);
+  return winner;
+}
+
+} // namespace reference
@@ -0,0 +1,42 @@
+#ifndef REFERENCE_HPP
+#define REFERENCE_HPP
+/* Reference.hpp
+ *
+ * Reference euchre rules, written to follow the project specification as
+ * literally as possible rather than to be fast.  These are frozen: the
+ * engine in Card.cpp, Player.cpp and Game.cpp may be optimized freely, and
+ * fuzz.exe checks that it still agrees with this file.  They read only a
+ * Card's rank and suit and a Pack's order, and keep their own copies of
+ * the card rules and of shuffling and dealing.
+ */
+
+#include "Card.hpp"
+#include "Game.hpp"
+#include "Player.hpp"
+#include <string>
+
+namespace reference {
+
+//EFFECTS Returns true if a is lower value than b, using trump
+bool Card_less(const Card &a, const Card &b, Suit trump);
+
+//EFFECTS Returns true if a is lower value than b, using trump and the suit led
+bool Card_less(const Card &a, const Card &b, const Card &led_card, Suit trump);
+
+//EFFECTS Returns the position in cards of the card winning the trick led by
+//  cards[0]
+int trick_winner(const Card cards[], Suit trump);
+
+//EFFECTS Returns a new player using the Simple strategy from the spec
+Player * Simple_factory(const std::string &name);
+
+//REQUIRES players holds four players with empty hands
+//MODIFIES state, players, obs
+//EFFECTS Plays a whole game exactly as euchre.exe does and returns the
+//  winning team
+int play_game(Game_state &state, Player *const players[],
+              const Game_config &config, Game_observer &obs);
+
+} // namespace reference
+
+#endif // REFERENCE_HPP
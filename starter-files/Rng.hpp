@@ -0,0 +1,53 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+/* Rng.hpp
+ *
+ * Small seedable pseudo-random number generator (SplitMix64).  The whole
+ * state is a single 64-bit word, so generators are cheap to copy, to seed
+ * one per game or thread, and to save and restore.
+ */
+
+#include <cstdint>
+
+class Rng {
+public:
+  // EFFECTS: Initializes the generator from seed.  Equal seeds produce equal
+  //          sequences.
+  explicit Rng(std::uint64_t seed = 0) : state(seed) {}
+
+  // EFFECTS: Returns the next 64 pseudo-random bits
+  std::uint64_t next() {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // REQUIRES: n > 0
+  // EFFECTS: Returns a pseudo-random integer in [0, n)
+  int below(int n) {
+    // Multiply-shift range reduction; the bias is below 2^-32 for the small
+    // ranges used here.
+    return static_cast<int>(((next() >> 32) * static_cast<std::uint64_t>(n))
+                            >> 32);
+  }
+
+  // EFFECTS: Returns the complete generator state
+  std::uint64_t get_state() const { return state; }
+
+  // EFFECTS: Restores a state returned by get_state()
+  void set_state(std::uint64_t state_in) { state = state_in; }
+
+private:
+  std::uint64_t state;
+};
+
+// EFFECTS: Returns the seed of game number game of a run seeded with seed.
+//          Each game draws its deals from an Rng of its own, so any game
+//          can be replayed alone and games can be split across threads.
+//          simulate.exe, tune.exe and deck corpora all number games so.
+inline std::uint64_t game_seed(std::uint64_t seed, std::uint64_t game) {
+  return Rng(seed ^ (game * 0xd1b54a32d192ed03ULL)).next();
+}
+
+#endif // RNG_HPP
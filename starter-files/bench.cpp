@@ -0,0 +1,158 @@
+// bench.cpp
+// Throughput of the lockstep batch engine against play_game() on the same
+// seeded games of four Simple players.  Also checks that both engines agree
+// on every game, and prints hardware counters per game for each engine.
+// Last, the rate at which a hand in progress forks (a copy of its Hand_state
+// and a clone of each player) and plays out.
+#include "Batch.hpp"
+#include "Game.hpp"
+#include "Pack.hpp"
+#include "PerfCounters.hpp"
+#include "Player.hpp"
+#include "Rng.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Game number index: a random deal, shuffling on odd games, and a random
+// target so that lanes finish at different times.
+static Batch_game bench_game(uint64_t index) {
+  Rng rng(index);
+  Batch_game g;
+  g.pack.shuffle(rng);
+  g.config.shuffle = index % 2 == 1;
+  g.config.points_to_win = 1 + rng.below(10);
+  return g;
+}
+
+static void play_scalar(const vector<Batch_game> &games,
+                        vector<Batch_result> &results) {
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  Player *players[4];
+  for (int i = 0; i < 4; ++i) players[i] = Player_factory(NAMES[i], "Simple");
+  Game_observer quiet;
+  for (size_t i = 0; i < games.size(); ++i) {
+    Game_state state{games[i].pack};
+    results[i].winner = play_game(state, players, games[i].config, quiet);
+    results[i].score[0] = state.score[0];
+    results[i].score[1] = state.score[1];
+    results[i].hands = state.hand;
+  }
+  for (Player *p : players) delete p;
+}
+
+static void play_lockstep(const vector<Batch_game> &games,
+                          vector<Batch_result> &results) {
+  for (size_t i = 0; i < games.size(); i += BATCH_LANES) {
+    int n = static_cast<int>(min(games.size() - i, size_t(BATCH_LANES)));
+    play_batch(&games[i], n, &results[i]);
+  }
+}
+
+// Forks a hand of four Simple players after its first trick n times, and
+// plays out every fork.  Returns the seconds taken by the forks alone and
+// by the forks and play outs.
+static void time_forks(size_t n, double &fork_seconds, double &total_seconds) {
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  Player *players[4];
+  for (int i = 0; i < 4; ++i) players[i] = Player_factory(NAMES[i], "Simple");
+  Pack pack = bench_game(0).pack;
+  Info_set info;
+  info.begin_hand(0, pack.deal_one());
+  info.make_trump(1, HEARTS, false);
+  Card_set hands[4] = {0, 0, 0, 0};
+  for (int seat = 0; seat < 4; ++seat) {
+    for (int j = 0; j < Player::MAX_HAND_SIZE; ++j) {
+      Card c = pack.deal_one();
+      players[seat]->add_card(c);
+      hands[seat] |= card_bit(c);
+    }
+  }
+  Hand_state s = start_play(info, hands);
+  for (int k = 0; k < 4; ++k) {
+    Player *p = players[s.to_play];
+    Card c = k == 0 ? p->lead_card(HEARTS)
+                    : p->play_card(s.info.trick_card(0), HEARTS);
+    apply_play(s, c);
+  }
+
+  int tricks = 0;  // keeps the play outs from being optimized away
+  for (int pass = 0; pass < 2; ++pass) {
+    PerfCounters clock;
+    PerfSample start = clock.read();
+    for (size_t i = 0; i < n; ++i) {
+      Hand_state fork = s;
+      Player *clones[4];
+      for (int seat = 0; seat < 4; ++seat) clones[seat] = players[seat]->clone();
+      if (pass == 1) play_out(fork, clones);
+      tricks += fork.tricks[0];
+      for (Player *p : clones) delete p;
+    }
+    (pass == 0 ? fork_seconds : total_seconds) = (clock.read() - start).seconds;
+  }
+  if (tricks < 0) cout << tricks;
+  for (Player *p : players) delete p;
+}
+
+int main(int argc, char *argv[]) {
+  size_t num_games = 200000;
+  if (argc == 3 && string(argv[1]) == "-n") {
+    num_games = strtoull(argv[2], nullptr, 10);
+  } else if (argc != 1) {
+    cout << "Usage: bench.exe [-n GAMES]" << endl;
+    return 1;
+  }
+
+  vector<Batch_game> games;
+  for (size_t i = 0; i < num_games; ++i) games.push_back(bench_game(i));
+  vector<Batch_result> scalar(num_games), batch(num_games);
+
+  PerfCounters counters;
+  PerfSample start = counters.read();
+  play_scalar(games, scalar);
+  PerfSample middle = counters.read();
+  play_lockstep(games, batch);
+  PerfSample scalar_stats = middle - start;
+  PerfSample batch_stats = counters.read() - middle;
+  double scalar_seconds = scalar_stats.seconds;
+  double batch_seconds = batch_stats.seconds;
+
+  size_t differ = 0;
+  for (size_t i = 0; i < num_games; ++i) {
+    const Batch_result &a = scalar[i], &b = batch[i];
+    if (a.winner != b.winner || a.score[0] != b.score[0] ||
+        a.score[1] != b.score[1] || a.hands != b.hands) {
+      if (++differ == 1) cout << "game " << i << " differs" << endl;
+    }
+  }
+
+  double games_count = static_cast<double>(num_games);
+  cout << num_games << " games, sizeof(Card) " << sizeof(Card)
+       << ", sizeof(Pack) " << sizeof(Pack) << '\n'
+       << "play_game:  " << games_count / scalar_seconds << " games/s\n"
+       << "play_batch: " << games_count / batch_seconds << " games/s ("
+       << batch_kernels() << ", " << BATCH_LANES << " lanes)\n"
+       << "speedup:    " << scalar_seconds / batch_seconds << "x\n"
+       << "per game, play_game:  ";
+  counters.print(cout, scalar_stats, games_count);
+  cout << "\nper game, play_batch: ";
+  counters.print(cout, batch_stats, games_count);
+  cout << endl;
+
+  double fork_seconds = 0, rollout_seconds = 0;
+  time_forks(num_games * 5, fork_seconds, rollout_seconds);
+  double forks = static_cast<double>(num_games * 5);
+  cout << "forks:      " << forks / fork_seconds << " forks/s, "
+       << forks / rollout_seconds << " forks played out/s (sizeof(Hand_state) "
+       << sizeof(Hand_state) << ")" << endl;
+  if (differ) {
+    cout << differ << " games differ" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,175 @@
+// corpus.cpp
+// Golden-corpus regression test.  Plays thousands of seeded games of four
+// Simple players and hashes each game's event stream as it happens, without
+// printing a transcript.  The hashes are compared with a stored manifest;
+// only games whose hash changed are replayed with a full transcript.
+#include "Game.hpp"
+#include "Pack.hpp"
+#include "Player.hpp"
+#include "Rng.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static const char *const MANIFEST_HEADER = "# euchre corpus v1";
+
+// Setup of corpus game number index, derived from the index alone so that
+// any single game can be replayed.
+struct Corpus_game {
+  explicit Corpus_game(uint64_t index) : rng(index) {
+    pack.shuffle(rng);
+    config.shuffle = index % 2 == 1;
+    config.points_to_win = 1 + rng.below(10);
+  }
+
+  Rng rng;
+  Pack pack;
+  Game_config config;
+};
+
+// FNV-1a over the fields of every event.  Hashing the events rather than
+// the text keeps the hot loop free of formatting, but any change to what the
+// transcript would say changes the hash.
+class Event_hash : public Game_observer {
+public:
+  void hand_begin(int hand, int dealer) override { add(1, hand, dealer); }
+  void upcard(const Card &c) override { add(2, code(c), 0); }
+  void pass(int seat) override { add(3, seat, 0); }
+  void order_up(int seat, Suit trump) override { add(4, seat, trump); }
+  void bidding_end() override { add(5, 0, 0); }
+  void card_led(int seat, const Card &c) override { add(6, seat, code(c)); }
+  void card_played(int seat, const Card &c) override {
+    add(7, seat, code(c));
+  }
+  void trick_won(int seat) override { add(8, seat, 0); }
+  void hand_end(const Hand_result &hr, const Game_state &state) override {
+    add(9, hr.march * 2 + hr.euchred, hr.tricks[0]);
+    add(10, state.score[0], state.score[1]);
+  }
+  void game_end(int team) override { add(11, team, 0); }
+
+  uint64_t value = 0xcbf29ce484222325ULL;
+
+private:
+  static int code(const Card &c) { return c.get_rank() * 4 + c.get_suit(); }
+
+  void add(int kind, int a, int b) {
+    const int bytes[] = {kind, a, b};
+    for (int x : bytes) {
+      value = (value ^ static_cast<uint8_t>(x)) * 0x100000001b3ULL;
+    }
+  }
+};
+
+// Plays corpus game index with four Simple players, reporting to obs.
+static void play_corpus_game(uint64_t index, Game_observer *obs,
+                             ostream *text) {
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  Player *players[4];
+  for (int i = 0; i < 4; ++i) players[i] = Player_factory(NAMES[i], "Simple");
+
+  Corpus_game game(index);
+  Game_state state{game.pack};
+  if (obs) {
+    play_game(state, players, game.config, *obs);
+  } else {
+    Transcript transcript(*text, players);
+    play_game(state, players, game.config, transcript);
+  }
+  for (Player *p : players) delete p;
+}
+
+// Hashes games [0, hashes.size()) on num_threads threads.
+static void hash_games(vector<uint64_t> &hashes, int num_threads) {
+  auto work = [&hashes, num_threads](int t) {
+    for (size_t i = t; i < hashes.size(); i += num_threads) {
+      Event_hash hash;
+      play_corpus_game(i, &hash, nullptr);
+      hashes[i] = hash.value;
+    }
+  };
+  vector<thread> pool;
+  for (int t = 1; t < num_threads; ++t) pool.emplace_back(work, t);
+  work(0);
+  for (thread &t : pool) t.join();
+}
+
+static int write_manifest(const string &path, size_t num_games,
+                          int num_threads) {
+  vector<uint64_t> hashes(num_games);
+  hash_games(hashes, num_threads);
+
+  ofstream out(path);
+  if (!out) {
+    cout << "Error opening " << path << endl;
+    return 1;
+  }
+  out << MANIFEST_HEADER << '\n' << hex << setfill('0');
+  for (uint64_t h : hashes) out << setw(16) << h << '\n';
+  cout << "wrote " << num_games << " game hashes to " << path << endl;
+  return 0;
+}
+
+static int check_manifest(const string &path, int num_threads) {
+  ifstream in(path);
+  string header;
+  if (!in || !getline(in, header) || header != MANIFEST_HEADER) {
+    cout << "Error reading manifest " << path << endl;
+    return 1;
+  }
+  vector<uint64_t> expected;
+  uint64_t h;
+  while (in >> hex >> h) expected.push_back(h);
+
+  vector<uint64_t> actual(expected.size());
+  hash_games(actual, num_threads);
+
+  // Regenerate transcripts only for the games that diverged
+  const size_t MAX_TRANSCRIPTS = 10;
+  size_t mismatches = 0;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (actual[i] == expected[i]) continue;
+    if (++mismatches <= MAX_TRANSCRIPTS) {
+      string out_path = "corpus_game_" + to_string(i) + ".out";
+      ofstream out(out_path);
+      play_corpus_game(i, nullptr, &out);
+      cout << "game " << i << " differs; transcript in " << out_path << endl;
+    }
+  }
+  cout << expected.size() - mismatches << " of " << expected.size()
+       << " games match " << path << endl;
+  return mismatches == 0 ? 0 : 1;
+}
+
+static void usage_and_exit() {
+  cout << "Usage: corpus.exe [-j THREADS] MANIFEST\n"
+       << "       corpus.exe [-j THREADS] --write MANIFEST [GAMES]" << endl;
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> args(argv + 1, argv + argc);
+  int num_threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+  if (args.size() >= 2 && args[0] == "-j") {
+    num_threads = max(1, atoi(args[1].c_str()));
+    args.erase(args.begin(), args.begin() + 2);
+  }
+
+  if (args.size() == 1 && args[0] != "--write") {
+    return check_manifest(args[0], num_threads);
+  }
+  if ((args.size() == 2 || args.size() == 3) && args[0] == "--write") {
+    size_t num_games = args.size() == 3 ? stoul(args[2]) : 10000;
+    return write_manifest(args[1], num_games, num_threads);
+  }
+  usage_and_exit();
+}
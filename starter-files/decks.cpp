@@ -0,0 +1,109 @@
+// decks.cpp
+// Writes and reads deck corpora (see Deck_corpus.hpp):
+//
+//   ./decks.exe write decks.dk -n 1000000 [-s SEED] [-j THREADS]
+//   ./decks.exe check decks.dk [-s SEED]
+//   ./decks.exe print decks.dk INDEX > pack.in
+//
+// check decodes every deck into a Pack, compares it with the deck the
+// seed draws and reports how fast decks are decoded; print writes one deck
+// in the format of pack.in, so euchre.exe can replay it.
+#include "Deck_corpus.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+static void usage_and_exit() {
+  cout << "Usage: decks.exe write CORPUS [-n DECKS] [-s SEED] [-j THREADS]\n"
+       << "       decks.exe check CORPUS [-s SEED]\n"
+       << "       decks.exe print CORPUS INDEX" << endl;
+  exit(1);
+}
+
+// Position of the upcard in a deck: after five cards to each seat
+static const int UPCARD = 20;
+
+static double seconds_since(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static int write(const string &path, uint64_t n, uint64_t seed,
+                 unsigned threads) {
+  auto start = chrono::steady_clock::now();
+  if (!write_deck_corpus(path, n, seed, threads)) {
+    cout << "Error writing " << path << endl;
+    return 1;
+  }
+  cerr << n << " decks written in " << seconds_since(start) << " s" << endl;
+  return 0;
+}
+
+static int check(const Deck_corpus &corpus, uint64_t seed) {
+  // Time decoding alone first, counting upcards that are jacks, which
+  // should be one in six; then compare with the decks drawn again
+  auto start = chrono::steady_clock::now();
+  uint64_t jacks = 0;
+  Pack pack;
+  for (uint64_t i = 0; i < corpus.size(); ++i) {
+    corpus.get(i, pack);
+    jacks += pack.get_cards()[UPCARD].get_rank() == JACK;
+  }
+  const double seconds = seconds_since(start);
+  uint64_t wrong = 0;
+  for (uint64_t i = 0; i < corpus.size(); ++i) {
+    corpus.get(i, pack);
+    wrong += pack.get_cards() != random_deck(seed, i);
+  }
+  const double decks = static_cast<double>(corpus.size());
+  cout << corpus.size() << " decks, " << wrong << " wrong, "
+       << 100 * static_cast<double>(jacks) / decks
+       << "% jacks turned up; " << decks / seconds
+       << " decks decoded per second" << endl;
+  return wrong != 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) usage_and_exit();
+  const string command = argv[1], path = argv[2];
+  if (command == "print") {
+    if (argc != 4) usage_and_exit();
+    Deck_corpus corpus(path);
+    const uint64_t index = strtoull(argv[3], nullptr, 10);
+    if (!corpus.is_open() || index >= corpus.size()) {
+      cout << "No deck " << index << " in " << path << endl;
+      return 1;
+    }
+    Pack pack;
+    corpus.get(index, pack);
+    for (const Card &c : pack.get_cards()) cout << c << "\n";
+    return 0;
+  }
+
+  uint64_t n = 1000000, seed = 1;
+  unsigned threads = thread::hardware_concurrency();
+  for (int i = 3; i < argc; ++i) {
+    const string arg = argv[i];
+    if (i + 1 == argc) usage_and_exit();
+    if (arg == "-n") {
+      n = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-s") {
+      seed = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-j") {
+      threads = static_cast<unsigned>(atoi(argv[++i]));
+    } else {
+      usage_and_exit();
+    }
+  }
+  if (command == "write") return write(path, n, seed, max(threads, 1u));
+  if (command != "check") usage_and_exit();
+  Deck_corpus corpus(path);
+  if (!corpus.is_open()) {
+    cout << "Error reading " << path << endl;
+    return 1;
+  }
+  return check(corpus, seed);
+}
@@ -0,0 +1,111 @@
+// endgame.cpp
+// Endgame tablebase: solves every position of the last tricks of a hand
+// (see Endgame.hpp) and checks a table against a full search:
+//
+//   ./endgame.exe write endgame.tb -t 3
+//   ./endgame.exe check endgame.tb -n 100000
+#include "Endgame.hpp"
+#include "Pack.hpp"
+#include "Rng.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void usage_and_exit() {
+  cout << "Usage: endgame.exe write TABLE [-t TRICKS]\n"
+       << "       endgame.exe check TABLE [-n POSITIONS] [-s SEED]" << endl;
+  exit(1);
+}
+
+static double seconds_since(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// A random position of k tricks
+struct Position {
+  Card_set hands[4];
+  Suit trump;
+  int leader;
+};
+
+static Position random_position(Rng &rng, int k) {
+  Pack pack;
+  pack.shuffle(rng);
+  Position p = {{0, 0, 0, 0}, static_cast<Suit>(rng.below(4)), rng.below(4)};
+  for (int seat = 0; seat < 4; ++seat) {
+    for (int i = 0; i < k; ++i) p.hands[seat] |= card_bit(pack.deal_one());
+  }
+  return p;
+}
+
+static int check_table(const string &path, uint64_t n, uint64_t seed) {
+  Endgame_table table(path);
+  if (!table.is_open()) {
+    cout << "Error opening " << path << endl;
+    return 1;
+  }
+  Rng rng(seed);
+  vector<Position> positions;
+  for (uint64_t i = 0; i < n; ++i) {
+    positions.push_back(random_position(rng, 1 + rng.below(table.max_tricks())));
+  }
+
+  auto start = chrono::steady_clock::now();
+  vector<int> looked_up;
+  for (const Position &p : positions) {
+    looked_up.push_back(table.lookup(p.hands, p.trump, p.leader));
+  }
+  double lookup_seconds = seconds_since(start);
+
+  start = chrono::steady_clock::now();
+  uint64_t wrong = 0;
+  for (size_t i = 0; i < positions.size(); ++i) {
+    const Position &p = positions[i];
+    wrong += solve_endgame(p.hands, p.trump, p.leader) != looked_up[i];
+  }
+  double search_seconds = seconds_since(start);
+
+  double count = static_cast<double>(n);
+  cout << n << " positions of up to " << table.max_tricks() << " tricks, "
+       << wrong << " wrong\n"
+       << "lookup: " << count / lookup_seconds << " positions/s\n"
+       << "search: " << count / search_seconds << " positions/s" << endl;
+  return wrong ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) usage_and_exit();
+  string command = argv[1];
+  uint64_t n = 100000, seed = 1;
+  int tricks = Endgame_table::MAX_TRICKS;
+  for (int i = 3; i < argc; ++i) {
+    string arg = argv[i];
+    if (i + 1 == argc) usage_and_exit();
+    if (arg == "-t" && command == "write") {
+      tricks = atoi(argv[++i]);
+    } else if (arg == "-n" && command == "check") {
+      n = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-s" && command == "check") {
+      seed = strtoull(argv[++i], nullptr, 10);
+    } else {
+      usage_and_exit();
+    }
+  }
+  if (command == "check") return check_table(argv[2], n, seed);
+  if (command != "write" || tricks < 1 || tricks > Endgame_table::MAX_TRICKS) {
+    usage_and_exit();
+  }
+
+  auto start = chrono::steady_clock::now();
+  if (!write_endgame_table(argv[2], tricks)) {
+    cout << "Error writing " << argv[2] << endl;
+    return 1;
+  }
+  cerr << "positions of up to " << tricks << " tricks solved in "
+       << seconds_since(start) << " s" << endl;
+  return 0;
+}
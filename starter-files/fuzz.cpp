@@ -0,0 +1,624 @@
+// fuzz.cpp
+// Differential fuzzer: runs random cards, hands and whole games through the
+// frozen rules in Reference.cpp and through every registered implementation,
+// and reports the first disagreement with a minimized reproducer.
+//
+// To check a new implementation, add it to the matching *_IMPLS table below.
+#include "Batch.hpp"
+#include "Card.hpp"
+#include "Game.hpp"
+#include "Pack.hpp"
+#include "Player.hpp"
+#include "Reference.hpp"
+#include "Rng.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Registered implementations
+
+struct Card_less_impl {
+  const char *name;
+  bool (*less)(const Card &, const Card &, Suit);
+};
+
+struct Card_less_led_impl {
+  const char *name;
+  bool (*less)(const Card &, const Card &, const Card &, Suit);
+};
+
+struct Trick_impl {
+  const char *name;
+  int (*winner)(const Card[], Suit);
+};
+
+struct Player_impl {
+  const char *name;
+  Player * (*make)(const string &name);
+};
+
+// An engine that plays many games of four Simple players at once
+struct Batch_impl {
+  const char *name;
+  void (*play)(const Batch_game[], int, Batch_result[]);
+};
+
+// A game engine together with the Simple players it plays with
+struct Game_impl {
+  const char *name;
+  int (*play)(Game_state &, Player *const[], const Game_config &,
+              Game_observer &);
+  Player * (*make)(const string &name);
+};
+
+static Player * make_simple(const string &name) {
+  return Player_factory(name, "Simple");
+}
+
+static const Card_less_impl CARD_LESS_IMPLS[] = {
+  {"Card_less", Card_less},
+};
+
+static const Card_less_led_impl CARD_LESS_LED_IMPLS[] = {
+  {"Card_less", Card_less},
+};
+
+static const Trick_impl TRICK_IMPLS[] = {
+  {"trick_winner", trick_winner},
+};
+
+static const Player_impl PLAYER_IMPLS[] = {
+  {"Simple", make_simple},
+};
+
+static const Game_impl GAME_IMPLS[] = {
+  {"play_game", play_game, make_simple},
+};
+
+static const Batch_impl BATCH_IMPLS[] = {
+  {"play_batch", play_batch},
+};
+
+template <class T, size_t N>
+static int count_of(const T (&)[N]) { return static_cast<int>(N); }
+
+// Random inputs
+
+static const Suit SUITS[] = {SPADES, HEARTS, CLUBS, DIAMONDS};
+
+static Suit random_suit(Rng &rng) { return SUITS[rng.below(4)]; }
+
+// Any of the 52 cards, so the rules are also exercised outside the euchre pack
+static Card random_card(Rng &rng) {
+  return Card(static_cast<Rank>(rng.below(13)), random_suit(rng));
+}
+
+static array<Card, Pack::PACK_SIZE> random_deck(Rng &rng) {
+  static const Rank RANKS[] = {NINE, TEN, JACK, QUEEN, KING, ACE};
+  array<Card, Pack::PACK_SIZE> deck;
+  for (int i = 0; i < Pack::PACK_SIZE; ++i) {
+    deck[i] = Card(RANKS[i % 6], SUITS[i / 6]);
+  }
+  for (int i = Pack::PACK_SIZE - 1; i > 0; --i) {
+    swap(deck[i], deck[rng.below(i + 1)]);
+  }
+  return deck;
+}
+
+static void print_deck(ostream &os, const array<Card, Pack::PACK_SIZE> &deck) {
+  for (const Card &c : deck) os << "  " << c << '\n';
+}
+
+// A check draws one random case from a seed and returns false if impl
+// disagrees with the reference.  report() reruns a failing seed, shrinks the
+// case where that makes sense and prints it.
+struct Check {
+  const char *name;
+  int (*num_impls)();
+  const char * (*impl_name)(int impl);
+  bool (*run)(uint64_t seed, int impl);
+  void (*report)(uint64_t seed, int impl, ostream &os);
+};
+
+// Card_less(a, b, trump)
+
+static bool card_less_run(uint64_t seed, int impl) {
+  Rng rng(seed);
+  Card a = random_card(rng), b = random_card(rng);
+  Suit trump = random_suit(rng);
+  return CARD_LESS_IMPLS[impl].less(a, b, trump) ==
+         reference::Card_less(a, b, trump);
+}
+
+static void card_less_report(uint64_t seed, int impl, ostream &os) {
+  Rng rng(seed);
+  Card a = random_card(rng), b = random_card(rng);
+  Suit trump = random_suit(rng);
+  os << "Card_less(" << a << ", " << b << ", " << trump << ")\n"
+     << "  reference: " << reference::Card_less(a, b, trump) << '\n'
+     << "  " << CARD_LESS_IMPLS[impl].name << ": "
+     << CARD_LESS_IMPLS[impl].less(a, b, trump) << '\n';
+}
+
+// Card_less(a, b, led_card, trump)
+
+static bool card_less_led_run(uint64_t seed, int impl) {
+  Rng rng(seed);
+  Card a = random_card(rng), b = random_card(rng), led = random_card(rng);
+  Suit trump = random_suit(rng);
+  return CARD_LESS_LED_IMPLS[impl].less(a, b, led, trump) ==
+         reference::Card_less(a, b, led, trump);
+}
+
+static void card_less_led_report(uint64_t seed, int impl, ostream &os) {
+  Rng rng(seed);
+  Card a = random_card(rng), b = random_card(rng), led = random_card(rng);
+  Suit trump = random_suit(rng);
+  os << "Card_less(" << a << ", " << b << ", " << led << ", " << trump
+     << ")\n"
+     << "  reference: " << reference::Card_less(a, b, led, trump) << '\n'
+     << "  " << CARD_LESS_LED_IMPLS[impl].name << ": "
+     << CARD_LESS_LED_IMPLS[impl].less(a, b, led, trump) << '\n';
+}
+
+// trick_winner
+
+static void random_trick(uint64_t seed, Card cards[], Suit &trump) {
+  Rng rng(seed);
+  array<Card, Pack::PACK_SIZE> deck = random_deck(rng);
+  copy(deck.begin(), deck.begin() + 4, cards);
+  trump = random_suit(rng);
+}
+
+static bool trick_run(uint64_t seed, int impl) {
+  Card cards[4];
+  Suit trump;
+  random_trick(seed, cards, trump);
+  return TRICK_IMPLS[impl].winner(cards, trump) ==
+         reference::trick_winner(cards, trump);
+}
+
+static void trick_report(uint64_t seed, int impl, ostream &os) {
+  Card cards[4];
+  Suit trump;
+  random_trick(seed, cards, trump);
+  os << "trump " << trump << ", trick:";
+  for (const Card &c : cards) os << ' ' << c << ';';
+  os << "\n  reference winner: " << reference::trick_winner(cards, trump)
+     << "\n  " << TRICK_IMPLS[impl].name << " winner: "
+     << TRICK_IMPLS[impl].winner(cards, trump) << '\n';
+}
+
+// Simple player decisions
+
+// One player's life through a hand: bidding in both rounds, possibly
+// picking up the upcard, then leading (no led card) or following until the
+// hand is empty.
+struct Player_case {
+  vector<Card> hand;
+  Card upcard;
+  Suit trump = SPADES;
+  bool is_dealer = false;
+  bool pick_up = false;
+  vector<bool> leads;     // one per play: lead if true, else follow led
+  vector<Card> led;
+};
+
+static Player_case random_player_case(uint64_t seed) {
+  Rng rng(seed);
+  array<Card, Pack::PACK_SIZE> deck = random_deck(rng);
+  Player_case pc;
+  int size = 1 + rng.below(Player::MAX_HAND_SIZE);
+  pc.hand.assign(deck.begin(), deck.begin() + size);
+  pc.upcard = deck[size];
+  pc.trump = random_suit(rng);
+  pc.is_dealer = rng.below(2);
+  pc.pick_up = size == Player::MAX_HAND_SIZE && rng.below(2);
+  for (int i = 0; i < size; ++i) {
+    pc.leads.push_back(rng.below(3) == 0);
+    pc.led.push_back(deck[size + 1 + i]);
+  }
+  return pc;
+}
+
+// Plays pc through both players and returns the first decision on which
+// they differ, or -1.  If os is given, every decision is printed.
+static int player_case_diff(const Player_case &pc, int impl, ostream *os) {
+  unique_ptr<Player> ref(reference::Simple_factory("reference"));
+  unique_ptr<Player> fast(PLAYER_IMPLS[impl].make("candidate"));
+  for (const Card &c : pc.hand) {
+    ref->add_card(c);
+    fast->add_card(c);
+  }
+  int step = 0;
+  for (int round = 1; round <= 2; ++round, ++step) {
+    Suit s1 = SPADES, s2 = SPADES;
+    bool r = ref->make_trump(pc.upcard, pc.is_dealer, round, s1);
+    bool f = fast->make_trump(pc.upcard, pc.is_dealer, round, s2);
+    if (os) {
+      *os << "  make_trump(" << pc.upcard << ", dealer=" << pc.is_dealer
+          << ", round " << round << "): " << r << ' ' << s1 << " vs " << f
+          << ' ' << s2 << '\n';
+    }
+    if (r != f || (r && s1 != s2)) return step;
+  }
+
+  Suit trump = pc.trump;
+  if (pc.pick_up) {
+    ref->add_and_discard(pc.upcard);
+    fast->add_and_discard(pc.upcard);
+    trump = pc.upcard.get_suit();
+    if (os) *os << "  add_and_discard(" << pc.upcard << ")\n";
+  }
+  for (size_t i = 0; i < pc.hand.size(); ++i, ++step) {
+    Card r, f;
+    if (pc.leads[i]) {
+      r = ref->lead_card(trump);
+      f = fast->lead_card(trump);
+      if (os) *os << "  lead_card(" << trump << "): ";
+    } else {
+      r = ref->play_card(pc.led[i], trump);
+      f = fast->play_card(pc.led[i], trump);
+      if (os) *os << "  play_card(" << pc.led[i] << ", " << trump << "): ";
+    }
+    if (os) *os << r << " vs " << f << '\n';
+    if (r != f) return step;
+  }
+  return -1;
+}
+
+static bool player_run(uint64_t seed, int impl) {
+  return player_case_diff(random_player_case(seed), impl, nullptr) == -1;
+}
+
+// Drops cards from the hand (and the plays they fed) while the case still
+// fails.
+static Player_case shrink(Player_case pc, int impl) {
+  bool progress = true;
+  while (progress && pc.hand.size() > 1) {
+    progress = false;
+    for (size_t i = 0; i < pc.hand.size(); ++i) {
+      Player_case smaller = pc;
+      smaller.hand.erase(smaller.hand.begin() + i);
+      smaller.leads.pop_back();
+      smaller.led.pop_back();
+      smaller.pick_up = pc.pick_up &&
+                        smaller.hand.size() == Player::MAX_HAND_SIZE;
+      if (player_case_diff(smaller, impl, nullptr) != -1) {
+        pc = smaller;
+        progress = true;
+        break;
+      }
+    }
+  }
+  return pc;
+}
+
+static void player_report(uint64_t seed, int impl, ostream &os) {
+  Player_case pc = shrink(random_player_case(seed), impl);
+  os << "hand:";
+  for (const Card &c : pc.hand) os << ' ' << c << ';';
+  os << "\nreference vs " << PLAYER_IMPLS[impl].name << ":\n";
+  int step = player_case_diff(pc, impl, &os);
+  os << "first difference at decision " << step << '\n';
+}
+
+// Whole games
+
+struct Game_case {
+  array<Card, Pack::PACK_SIZE> deck;
+  Game_config config;
+};
+
+static Game_case random_game_case(uint64_t seed) {
+  Rng rng(seed);
+  Game_case gc;
+  gc.deck = random_deck(rng);
+  gc.config.shuffle = rng.below(2);
+  gc.config.points_to_win = 1 + rng.below(10);
+  return gc;
+}
+
+// Records every event of a game in a compact form for comparison.
+class Event_log : public Game_observer {
+public:
+  void hand_begin(int hand, int dealer) override { add(1, hand, dealer); }
+  void upcard(const Card &c) override { add(2, code(c), 0); }
+  void pass(int seat) override { add(3, seat, 0); }
+  void order_up(int seat, Suit trump) override { add(4, seat, trump); }
+  void card_led(int seat, const Card &c) override { add(5, seat, code(c)); }
+  void card_played(int seat, const Card &c) override {
+    add(6, seat, code(c));
+  }
+  void trick_won(int seat) override { add(7, seat, 0); }
+  void hand_end(const Hand_result &, const Game_state &state) override {
+    add(8, state.score[0], state.score[1]);
+  }
+  void game_end(int team) override { add(9, team, 0); }
+
+  vector<uint32_t> events;
+
+private:
+  static int code(const Card &c) { return c.get_rank() * 4 + c.get_suit(); }
+  void add(int kind, int a, int b) {
+    events.push_back(static_cast<uint32_t>(kind << 24 | a << 12 | b));
+  }
+};
+
+using Game_fn = int (*)(Game_state &, Player *const[], const Game_config &,
+                        Game_observer &);
+using Player_fn = Player * (*)(const string &);
+
+// Plays gc with the given engine and players, reporting to obs, or printing
+// the transcript to text if obs is null.
+static void play_case(const Game_case &gc, Game_fn play, Player_fn make,
+                      Game_observer *obs, ostream *text) {
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  Player *players[4];
+  for (int i = 0; i < 4; ++i) players[i] = make(NAMES[i]);
+  Game_state state{Pack(gc.deck)};
+  if (obs) {
+    play(state, players, gc.config, *obs);
+  } else {
+    Transcript transcript(*text, players);
+    play(state, players, gc.config, transcript);
+  }
+  for (Player *p : players) delete p;
+}
+
+static bool game_case_agrees(const Game_case &gc, int impl) {
+  Event_log ref, fast;
+  const Game_impl &gi = GAME_IMPLS[impl];
+  play_case(gc, reference::play_game, reference::Simple_factory, &ref,
+            nullptr);
+  play_case(gc, gi.play, gi.make, &fast, nullptr);
+  return ref.events == fast.events;
+}
+
+static bool game_run(uint64_t seed, int impl) {
+  return game_case_agrees(random_game_case(seed), impl);
+}
+
+static void game_report(uint64_t seed, int impl, ostream &os) {
+  Game_case gc = random_game_case(seed);
+  // The shortest game that still diverges
+  for (int points = 1; points < gc.config.points_to_win; ++points) {
+    Game_case shorter = gc;
+    shorter.config.points_to_win = points;
+    if (!game_case_agrees(shorter, impl)) {
+      gc = shorter;
+      break;
+    }
+  }
+  os << "pack (pack.in format):\n";
+  print_deck(os, gc.deck);
+  os << (gc.config.shuffle ? "shuffle" : "noshuffle") << ", "
+     << gc.config.points_to_win << " points to win\n";
+
+  // Show the first transcript line that differs
+  const Game_impl &gi = GAME_IMPLS[impl];
+  ostringstream ref_text, fast_text;
+  play_case(gc, reference::play_game, reference::Simple_factory, nullptr,
+            &ref_text);
+  play_case(gc, gi.play, gi.make, nullptr, &fast_text);
+  istringstream ref_lines(ref_text.str()), fast_lines(fast_text.str());
+  string r, f;
+  int line = 0;
+  while (getline(ref_lines, r) && getline(fast_lines, f) && r == f) ++line;
+  os << "first difference at transcript line " << line + 1 << ":\n"
+     << "  reference: " << r << "\n  " << gi.name << ": " << f << '\n';
+}
+
+// Batches of whole games
+
+// A batch of 1 to BATCH_LANES games, each a random game case
+static vector<Game_case> random_batch(uint64_t seed) {
+  Rng rng(seed);
+  vector<Game_case> batch(1 + rng.below(BATCH_LANES));
+  for (Game_case &gc : batch) gc = random_game_case(rng.next());
+  return batch;
+}
+
+// Returns the lane where impl's result differs from the reference, or -1.
+static int batch_diff(const vector<Game_case> &batch, int impl,
+                      ostream *os) {
+  int n = static_cast<int>(batch.size());
+  vector<Batch_game> games;
+  for (const Game_case &gc : batch) {
+    games.push_back({Pack(gc.deck), gc.config});
+  }
+  Batch_result results[BATCH_LANES];
+  BATCH_IMPLS[impl].play(games.data(), n, results);
+
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  for (int i = 0; i < n; ++i) {
+    Player *players[4];
+    for (int p = 0; p < 4; ++p) {
+      players[p] = reference::Simple_factory(NAMES[p]);
+    }
+    Game_state state{games[i].pack};
+    Game_observer quiet;
+    int winner = reference::play_game(state, players, games[i].config, quiet);
+    for (Player *p : players) delete p;
+
+    const Batch_result &r = results[i];
+    if (r.winner == winner && r.score[0] == state.score[0] &&
+        r.score[1] == state.score[1] && r.hands == state.hand) {
+      continue;
+    }
+    if (os) {
+      *os << "lane " << i << " of " << n << "\nreference: team " << winner
+          << " wins " << state.score[0] << '-' << state.score[1] << " after "
+          << state.hand << " hands\n" << BATCH_IMPLS[impl].name << ": team "
+          << r.winner << " wins " << r.score[0] << '-' << r.score[1]
+          << " after " << r.hands << " hands\n";
+    }
+    return i;
+  }
+  return -1;
+}
+
+static bool batch_run(uint64_t seed, int impl) {
+  return batch_diff(random_batch(seed), impl, nullptr) == -1;
+}
+
+static void batch_report(uint64_t seed, int impl, ostream &os) {
+  vector<Game_case> batch = random_batch(seed);
+  int lane = batch_diff(batch, impl, &os);
+  if (lane == -1) return;
+  const Game_case &gc = batch[lane];
+  os << "pack (pack.in format):\n";
+  print_deck(os, gc.deck);
+  os << (gc.config.shuffle ? "shuffle" : "noshuffle") << ", "
+     << gc.config.points_to_win << " points to win\n";
+}
+
+static const Check CHECKS[] = {
+  {"card_less",
+   [] { return count_of(CARD_LESS_IMPLS); },
+   [](int i) { return CARD_LESS_IMPLS[i].name; },
+   card_less_run, card_less_report},
+  {"card_less_led",
+   [] { return count_of(CARD_LESS_LED_IMPLS); },
+   [](int i) { return CARD_LESS_LED_IMPLS[i].name; },
+   card_less_led_run, card_less_led_report},
+  {"trick",
+   [] { return count_of(TRICK_IMPLS); },
+   [](int i) { return TRICK_IMPLS[i].name; },
+   trick_run, trick_report},
+  {"player",
+   [] { return count_of(PLAYER_IMPLS); },
+   [](int i) { return PLAYER_IMPLS[i].name; },
+   player_run, player_report},
+  {"game",
+   [] { return count_of(GAME_IMPLS); },
+   [](int i) { return GAME_IMPLS[i].name; },
+   game_run, game_report},
+  {"batch",
+   [] { return count_of(BATCH_IMPLS); },
+   [](int i) { return BATCH_IMPLS[i].name; },
+   batch_run, batch_report},
+};
+
+// Driver
+
+static void usage_and_exit(const char *exe) {
+  cout << "Usage: " << exe << " [-j THREADS] [-n CASES] [-s SEED] [CHECK ...]"
+       << "\nChecks:";
+  for (const Check &c : CHECKS) cout << ' ' << c.name;
+  cout << endl;
+  exit(1);
+}
+
+// Shared between worker threads: the next seed to claim and the smallest
+// failing seed found so far.
+struct Fuzz_run {
+  vector<const Check *> checks;
+  uint64_t first_seed = 0;
+  uint64_t num_cases = 0;
+  atomic<uint64_t> next{0};
+  atomic<uint64_t> comparisons{0};
+  mutex lock;
+  bool failed = false;
+  uint64_t fail_seed = 0;
+  const Check *fail_check = nullptr;
+  int fail_impl = 0;
+};
+
+static void record_failure(Fuzz_run &run, uint64_t seed, const Check *check,
+                           int impl) {
+  lock_guard<mutex> guard(run.lock);
+  if (!run.failed || seed < run.fail_seed) {
+    run.failed = true;
+    run.fail_seed = seed;
+    run.fail_check = check;
+    run.fail_impl = impl;
+  }
+}
+
+// Claims seeds in blocks until the cases run out or a failure is found.
+// Seeds below a known failure are still finished so the reported failure is
+// the first one regardless of the number of threads.
+static void fuzz_worker(Fuzz_run &run) {
+  const uint64_t BLOCK = 256;
+  for (;;) {
+    uint64_t begin = run.next.fetch_add(BLOCK);
+    if (begin >= run.num_cases) return;
+    {
+      lock_guard<mutex> guard(run.lock);
+      if (run.failed && run.first_seed + begin > run.fail_seed) return;
+    }
+    uint64_t end = min(begin + BLOCK, run.num_cases);
+    uint64_t done = 0;
+    for (uint64_t i = begin; i < end; ++i) {
+      uint64_t seed = run.first_seed + i;
+      for (const Check *check : run.checks) {
+        for (int impl = 0; impl < check->num_impls(); ++impl, ++done) {
+          if (!check->run(seed, impl)) record_failure(run, seed, check, impl);
+        }
+      }
+    }
+    run.comparisons += done;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  Fuzz_run run;
+  run.num_cases = 100000;
+  int threads = static_cast<int>(thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if ((arg == "-j" || arg == "-n" || arg == "-s") && i + 1 == argc) {
+      usage_and_exit(argv[0]);
+    }
+    if (arg == "-j") {
+      threads = atoi(argv[++i]);
+    } else if (arg == "-n") {
+      run.num_cases = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-s") {
+      run.first_seed = strtoull(argv[++i], nullptr, 10);
+    } else {
+      auto match = find_if(begin(CHECKS), end(CHECKS),
+                           [&arg](const Check &c) { return arg == c.name; });
+      if (match == end(CHECKS)) usage_and_exit(argv[0]);
+      run.checks.push_back(match);
+    }
+  }
+  if (run.checks.empty()) {
+    for (const Check &c : CHECKS) run.checks.push_back(&c);
+  }
+  threads = max(threads, 1);
+
+  auto start = chrono::steady_clock::now();
+  vector<thread> pool;
+  for (int i = 1; i < threads; ++i) pool.emplace_back(fuzz_worker, ref(run));
+  fuzz_worker(run);
+  for (thread &t : pool) t.join();
+  double seconds = chrono::duration<double>(
+    chrono::steady_clock::now() - start).count();
+
+  cout << run.comparisons << " comparisons on " << threads << " threads in "
+       << seconds << " s (" << run.comparisons / max(seconds, 1e-9)
+       << " per second)" << endl;
+  if (!run.failed) {
+    cout << "no differences from the reference" << endl;
+    return 0;
+  }
+  cout << "DIFFERENCE in check " << run.fail_check->name << ", "
+       << run.fail_check->impl_name(run.fail_impl) << ", seed "
+       << run.fail_seed << " (rerun with -s " << run.fail_seed << " -n 1 "
+       << run.fail_check->name << ")" << endl;
+  run.fail_check->report(run.fail_seed, run.fail_impl, cout);
+  return 1;
+}
@@ -0,0 +1,198 @@
+// hands.cpp
+// Hand-history store: records the facts of every hand of simulated games in
+// a columnar store (see Hand_store.hpp), and answers questions about them
+// without playing again, for example how often a maker whose only trump is
+// the left bower is euchred:
+//
+//   ./hands.exe write hands.db -n 1000000
+//   ./hands.exe query hands.db maker_trumps=1 maker_left=1 avg euchred
+#include "Game.hpp"
+#include "Hand_store.hpp"
+#include "Pack.hpp"
+#include "Player.hpp"
+#include "Rng.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static void usage_and_exit() {
+  cout << "Usage: hands.exe write STORE [-n GAMES] [-s SEED]\n"
+       << "       hands.exe query STORE [COLUMN{=,!=,<,<=,>,>=}VALUE]... "
+       << "[avg COLUMN] [by COLUMN]\n"
+       << "Columns:";
+  for (int c = 0; c < NUM_HAND_COLUMNS; ++c) cout << ' ' << hand_column_name(c);
+  cout << endl;
+  exit(1);
+}
+
+static double seconds_since(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Adds a row to the store at the end of every hand
+class Recorder : public Game_observer {
+public:
+  explicit Recorder(Hand_store_writer &writer_in) : writer(writer_in) {}
+
+  void hands_dealt(const Card_set hands[]) override {
+    for (int seat = 0; seat < 4; ++seat) dealt[seat] = hands[seat];
+  }
+
+  void hand_end(const Hand_result &result, const Game_state &state) override {
+    writer.add(make_hand_row(result, dealt));
+  }
+
+private:
+  Hand_store_writer &writer;
+  Card_set dealt[4] = {0, 0, 0, 0};
+};
+
+// Four Simple players, each hand dealt from a random pack drawn from seed
+static int write_store(const string &path, uint64_t games, uint64_t seed) {
+  Hand_store_writer writer(path);
+  if (!writer.good()) {
+    cout << "Error opening " << path << endl;
+    return 1;
+  }
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  Player *players[4];
+  for (int i = 0; i < 4; ++i) players[i] = Player_factory(NAMES[i], "Simple");
+
+  auto start = chrono::steady_clock::now();
+  Recorder recorder(writer);
+  Game_config config;
+  Rng rng(seed);
+  uint64_t hands = 0;
+  for (uint64_t g = 0; g < games; ++g) {
+    Game_state state;
+    while (!game_over(state, config)) {
+      state.pack.shuffle(rng);
+      play_hand(state, players, config, recorder);
+      ++hands;
+    }
+  }
+  for (Player *p : players) delete p;
+  if (!writer.close()) {
+    cout << "Error writing " << path << endl;
+    return 1;
+  }
+  cerr << hands << " hands written in " << seconds_since(start) << " s"
+       << endl;
+  return 0;
+}
+
+// Parses COLUMN OP VALUE, for example "maker_trumps<=2"
+static bool parse_filter(const string &arg, Hand_filter &f) {
+  static const struct { const char *text; Hand_filter::Op op; } OPS[] = {
+    {"!=", Hand_filter::NE}, {"<=", Hand_filter::LE}, {">=", Hand_filter::GE},
+    {"=", Hand_filter::EQ}, {"<", Hand_filter::LT}, {">", Hand_filter::GT},
+  };
+  for (const auto &op : OPS) {
+    size_t at = arg.find(op.text);
+    if (at == string::npos || at == 0) continue;
+    string value = arg.substr(at + char_traits<char>::length(op.text));
+    if (value.empty() ||
+        value.find_first_not_of("0123456789") != string::npos) {
+      return false;
+    }
+    f.column = find_hand_column(arg.substr(0, at));
+    f.op = op.op;
+    f.value = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+    return f.column >= 0;
+  }
+  return false;
+}
+
+static Hand_query parse_query(int argc, char *argv[]) {
+  Hand_query q;
+  for (int i = 3; i < argc; ++i) {
+    string arg = argv[i];
+    if ((arg == "avg" || arg == "by") && i + 1 < argc) {
+      int c = find_hand_column(argv[++i]);
+      if (c < 0) usage_and_exit();
+      (arg == "avg" ? q.average : q.group_by) = c;
+    } else {
+      Hand_filter f;
+      if (!parse_filter(arg, f)) usage_and_exit();
+      q.filters.push_back(f);
+    }
+  }
+  return q;
+}
+
+static void print_row(const Hand_query &q, const Hand_query_result &r,
+                      size_t g, uint64_t total) {
+  cout << setw(12) << r.count[g] << setw(9)
+       << (total ? 100.0 * static_cast<double>(r.count[g]) /
+                   static_cast<double>(total) : 0) << '%';
+  if (q.average >= 0) {
+    cout << setw(20) << (r.count[g] ? static_cast<double>(r.sum[g]) /
+                                      static_cast<double>(r.count[g]) : 0);
+  }
+  cout << '\n';
+}
+
+static int query_store(const string &path, const Hand_query &q) {
+  Hand_store store(path);
+  if (!store.is_open()) {
+    cout << "Error opening " << path << endl;
+    return 1;
+  }
+  if (q.group_by >= 0 && store.max_value(q.group_by) >= Hand_store::MAX_GROUPS) {
+    cout << "Error: too many values to group by "
+         << hand_column_name(q.group_by) << endl;
+    return 1;
+  }
+
+  auto start = chrono::steady_clock::now();
+  Hand_query_result r = store.run(q);
+  double seconds = seconds_since(start);
+
+  uint64_t matched = 0;
+  for (uint64_t n : r.count) matched += n;
+  cout << fixed << setprecision(4) << matched << " of " << store.rows()
+       << " hands match\n";
+  cout << setw(12) << (q.group_by >= 0 ? hand_column_name(q.group_by) : "")
+       << setw(12) << "hands" << setw(10) << "share";
+  if (q.average >= 0) cout << setw(20) << string("avg ") +
+                                          hand_column_name(q.average);
+  cout << '\n';
+  for (size_t g = 0; g < r.count.size(); ++g) {
+    if (q.group_by >= 0 && r.count[g] == 0) continue;
+    if (q.group_by >= 0) {
+      cout << setw(12) << g;
+    } else {
+      cout << setw(12) << "all";
+    }
+    print_row(q, r, g, matched);
+  }
+  cerr << r.blocks << " blocks, " << r.blocks_skipped << " skipped by min/max; "
+       << static_cast<double>(store.rows()) / seconds << " hands/s" << endl;
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) usage_and_exit();
+  string command = argv[1];
+  if (command == "write") {
+    uint64_t games = 100000, seed = 1;
+    for (int i = 3; i < argc; ++i) {
+      string arg = argv[i];
+      if (i + 1 == argc) usage_and_exit();
+      if (arg == "-n") {
+        games = strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "-s") {
+        seed = strtoull(argv[++i], nullptr, 10);
+      } else {
+        usage_and_exit();
+      }
+    }
+    return write_store(argv[2], games, seed);
+  }
+  if (command == "query") return query_store(argv[2], parse_query(argc, argv));
+  usage_and_exit();
+}
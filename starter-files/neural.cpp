@@ -0,0 +1,376 @@
+// neural.cpp
+// Weights for the "Neural" strategy (see Neural.hpp), and how fast and how
+// well they play:
+//
+//   ./neural.exe train neural.weights -n 1000
+//   ./neural.exe bench neural.weights -n 10000
+//
+// Training teaches the network to pick the option Simple picks: four Simple
+// players play random deals while every decision is recorded with its
+// options, and the network is fit to them by gradient descent on the
+// softmax of its scores.  The weights are then quantized to 8 bits.
+#include "Euchre.hpp"
+#include "Neural.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void usage_and_exit() {
+  cout << "Usage: neural.exe train WEIGHTS [-n GAMES] [-s SEED]\n"
+       << "       neural.exe bench WEIGHTS [-n GAMES] [-s SEED]" << endl;
+  exit(1);
+}
+
+static double seconds_since(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static const char *const NAMES[] = {"North", "East", "South", "West"};
+
+// Recorded decisions: the rows of each one's options, and the option taken
+struct Examples {
+  vector<Neural_row> rows;
+  vector<size_t> first{0};   // decision i has rows [first[i], first[i + 1])
+  vector<int> taken;
+
+  void add(const Neural_decision &d, int option) {
+    rows.insert(rows.end(), d.rows, d.rows + d.options);
+    first.push_back(rows.size());
+    taken.push_back(option);
+  }
+};
+
+static Card_set held_by(Player *p, Suit trump) {
+  // A clone lays its hand down without touching p
+  unique_ptr<Player> probe(p->clone());
+  Card_set cards = 0;
+  for (int i = 0; i < Player::MAX_HAND_SIZE; ++i) {
+    cards |= card_bit(probe->lead_card(trump));
+  }
+  return cards;
+}
+
+// A Simple player that records each decision as a Neural player sees it
+class Teacher : public Player {
+public:
+  Teacher(const string &name, Examples &examples_in)
+    : simple(Player_factory(name, "Simple")), examples(examples_in) {}
+
+  const string & get_name() const override { return simple->get_name(); }
+
+  void add_card(const Card &c) override {
+    hand |= card_bit(c);
+    simple->add_card(c);
+  }
+
+  bool make_trump(const Card &upcard, bool is_dealer,
+                  int round, Suit &order_up_suit) const override {
+    Neural_decision d;
+    bid_options(hand, {upcard, is_dealer, round}, d);
+    bool order = simple->make_trump(upcard, is_dealer, round, order_up_suit);
+    for (int i = 0; i < d.options; ++i) {
+      if (d.pass[i] ? !order : order && d.suits[i] == order_up_suit) {
+        examples.add(d, i);
+      }
+    }
+    return order;
+  }
+
+  void add_and_discard(const Card &upcard) override {
+    hand |= card_bit(upcard);
+    Neural_decision d;
+    discard_options(hand, upcard.get_suit(), d);
+    simple->add_and_discard(upcard);
+    Card_set kept = held_by(simple.get(), upcard.get_suit());
+    for (int i = 0; i < d.options; ++i) {
+      if (!(kept & card_bit(d.cards[i]))) examples.add(d, i);
+    }
+    hand = kept;
+  }
+
+  Card lead_card(Suit trump) override {
+    return record(trump, simple->lead_card(trump));
+  }
+
+  Card play_card(const Card &led_card, Suit trump) override {
+    return record(trump, simple->play_card(led_card, trump));
+  }
+
+  void clear_hand() override {
+    hand = 0;
+    simple->clear_hand();
+  }
+
+  void watch(const Info_set &info_in) override { info = &info_in; }
+
+private:
+  Card record(Suit trump, const Card &c) {
+    if (info->trump_made() && !info->sits_out(seat_to_play(*info, seat))) {
+      seat = seat_to_play(*info, seat);
+      Neural_decision d;
+      card_options(hand, *info, seat, d);
+      for (int i = 0; i < d.options; ++i) {
+        if (d.cards[i] == c) examples.add(d, i);
+      }
+    }
+    hand &= ~card_bit(c);
+    return c;
+  }
+
+  unique_ptr<Player> simple;
+  Examples &examples;
+  const Info_set *info = nullptr;
+  Card_set hand = 0;
+  int seat = 0;
+};
+
+// The network in floating point, as it is trained
+struct Float_mlp {
+  float w1[Mlp::HIDDEN][Mlp::INPUTS];
+  float b1[Mlp::HIDDEN];
+  float w2[Mlp::HIDDEN];
+  float b2 = 0;
+
+  float score(const Neural_row &row, float hidden[]) const {
+    float out = b2;
+    for (int h = 0; h < Mlp::HIDDEN; ++h) {
+      float sum = b1[h];
+      for (int i = 0; i < Mlp::INPUTS; ++i) sum += w1[h][i] * row.x[i];
+      hidden[h] = max(sum, 0.0f);
+      out += w2[h] * hidden[h];
+    }
+    return out;
+  }
+};
+
+// One step of gradient descent on decision i's cross-entropy
+static void train_step(Float_mlp &net, const Examples &ex, size_t i,
+                       float rate) {
+  const size_t first = ex.first[i];
+  const int n = static_cast<int>(ex.first[i + 1] - first);
+  float hidden[Neural_decision::MAX_OPTIONS][Mlp::HIDDEN];
+  float p[Neural_decision::MAX_OPTIONS];
+  for (int j = 0; j < n; ++j) p[j] = net.score(ex.rows[first + j], hidden[j]);
+  const float top = *max_element(p, p + n);
+  float total = 0;
+  for (int j = 0; j < n; ++j) total += p[j] = exp(p[j] - top);
+  for (int j = 0; j < n; ++j) {
+    const float g = rate * (p[j] / total - (j == ex.taken[i]));
+    const Neural_row &row = ex.rows[first + j];
+    for (int h = 0; h < Mlp::HIDDEN; ++h) {
+      if (hidden[j][h] > 0) {
+        const float gh = g * net.w2[h];
+        for (int k = 0; k < Mlp::INPUTS; ++k) net.w1[h][k] -= gh * row.x[k];
+        net.b1[h] -= gh;
+      }
+      net.w2[h] -= g * hidden[j][h];
+    }
+    net.b2 -= g;
+  }
+}
+
+static int8_t to_byte(float x) {
+  return static_cast<int8_t>(max(-127.0f, min(127.0f, round(x))));
+}
+
+// 8-bit weights scaled to their largest, and a shift that brings the
+// largest hidden unit seen in training down to the top of a byte
+static Mlp quantize(const Float_mlp &net, const Examples &ex) {
+  float w1_max = 1e-6f, w2_max = 1e-6f, hidden_max = 1e-6f;
+  for (int h = 0; h < Mlp::HIDDEN; ++h) {
+    for (int i = 0; i < Mlp::INPUTS; ++i) {
+      w1_max = max(w1_max, fabs(net.w1[h][i]));
+    }
+    w2_max = max(w2_max, fabs(net.w2[h]));
+  }
+  for (const Neural_row &row : ex.rows) {
+    float hidden[Mlp::HIDDEN];
+    net.score(row, hidden);
+    hidden_max = max(hidden_max, *max_element(hidden, hidden + Mlp::HIDDEN));
+  }
+  const float q1 = 127 / w1_max, q2 = 127 / w2_max;
+  Mlp mlp;
+  mlp.shift = max(0, static_cast<int>(ceil(log2(hidden_max * q1 / 127))));
+  const float qh = q1 / static_cast<float>(1 << mlp.shift);
+  for (int h = 0; h < Mlp::HIDDEN; ++h) {
+    for (int i = 0; i < Mlp::INPUTS; ++i) {
+      mlp.w1[h][i] = to_byte(net.w1[h][i] * q1);
+    }
+    mlp.b1[h] = static_cast<int32_t>(round(net.b1[h] * q1));
+    mlp.w2[h] = to_byte(net.w2[h] * q2);
+  }
+  mlp.b2 = static_cast<int32_t>(round(net.b2 * q2 * qh));
+  return mlp;
+}
+
+// Share of decisions in which mlp takes the recorded option
+static double agreement(const Mlp &mlp, const Examples &ex) {
+  size_t agree = 0;
+  for (size_t i = 0; i < ex.taken.size(); ++i) {
+    int32_t scores[Neural_decision::MAX_OPTIONS];
+    const size_t first = ex.first[i];
+    const int n = static_cast<int>(ex.first[i + 1] - first);
+    mlp_evaluate(mlp, &ex.rows[first], n, scores);
+    agree += max_element(scores, scores + n) - scores == ex.taken[i];
+  }
+  return static_cast<double>(agree) / static_cast<double>(ex.taken.size());
+}
+
+static int train(const string &path, uint64_t games, uint64_t seed) {
+  auto start = chrono::steady_clock::now();
+  Examples ex;
+  Player *players[4];
+  for (int i = 0; i < 4; ++i) players[i] = new Teacher(NAMES[i], ex);
+  for (uint64_t g = 0; g < games; ++g) Game(seed + g, players).play();
+  for (Player *p : players) delete p;
+  cerr << ex.taken.size() << " decisions recorded in " << seconds_since(start)
+       << " s" << endl;
+
+  start = chrono::steady_clock::now();
+  Rng rng(seed);
+  Float_mlp net;
+  for (int h = 0; h < Mlp::HIDDEN; ++h) {
+    for (int i = 0; i < Mlp::INPUTS; ++i) {
+      net.w1[h][i] = static_cast<float>(rng.below(2001) - 1000) / 10000;
+    }
+    net.b1[h] = 0.1f;
+    net.w2[h] = static_cast<float>(rng.below(2001) - 1000) / 10000;
+  }
+  vector<size_t> order(ex.taken.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  const int EPOCHS = 4;
+  for (int epoch = 0; epoch < EPOCHS; ++epoch) {
+    for (size_t i = order.size(); i > 1; --i) {
+      swap(order[i - 1], order[rng.below(static_cast<int>(i))]);
+    }
+    const float rate = 0.01f / static_cast<float>(1 + epoch);
+    for (size_t i : order) train_step(net, ex, i, rate);
+  }
+
+  Mlp mlp = quantize(net, ex);
+  if (!save_mlp(path, mlp)) {
+    cout << "Error writing " << path << endl;
+    return 1;
+  }
+  cout << "agrees with Simple on " << 100 * agreement(mlp, ex)
+       << "% of decisions" << endl;
+  cerr << "trained in " << seconds_since(start) << " s" << endl;
+  return 0;
+}
+
+// Random hands of four Neural players, from just before the first lead
+static vector<Hand_state> random_hands(Rng &rng, int n) {
+  vector<Hand_state> states;
+  for (int i = 0; i < n; ++i) {
+    Pack pack;
+    pack.shuffle(rng);
+    Info_set info;
+    info.begin_hand(rng.below(4), pack.deal_one());
+    info.make_trump(rng.below(4), static_cast<Suit>(rng.below(4)), false);
+    Card_set hands[4] = {0, 0, 0, 0};
+    for (int seat = 0; seat < 4; ++seat) {
+      for (int j = 0; j < Player::MAX_HAND_SIZE; ++j) {
+        hands[seat] |= card_bit(pack.deal_one());
+      }
+    }
+    states.push_back(start_play(info, hands));
+  }
+  return states;
+}
+
+// Plays every hand out, choosing cards for group states at a time
+static uint64_t play_out_batched(const Mlp &mlp, vector<Hand_state> &states,
+                                 int group) {
+  vector<Card> cards(states.size());
+  uint64_t decisions = 0;
+  for (int trick = 0; trick < 5; ++trick) {
+    for (int step = 0; step < 4; ++step) {
+      for (size_t i = 0; i < states.size(); i += group) {
+        int n = static_cast<int>(min(states.size() - i, size_t(group)));
+        neural_choose_batch(mlp, &states[i], n, &cards[i]);
+      }
+      for (size_t i = 0; i < states.size(); ++i) {
+        apply_play(states[i], cards[i]);
+      }
+      decisions += states.size();
+    }
+  }
+  return decisions;
+}
+
+static int bench(const string &path, uint64_t games, uint64_t seed) {
+  Mlp mlp;
+  if (!load_mlp(path, mlp)) {
+    cout << "Error reading " << path << endl;
+    return 1;
+  }
+
+  // Neural in seats 0 and 2 against Simple, then the other way round
+  Player *players[4];
+  uint64_t wins = 0;
+  auto start = chrono::steady_clock::now();
+  for (int swap_seats = 0; swap_seats < 2; ++swap_seats) {
+    for (int i = 0; i < 4; ++i) {
+      players[i] = i % 2 == swap_seats ? Neural_factory(NAMES[i], mlp)
+                                       : Player_factory(NAMES[i], "Simple");
+    }
+    for (uint64_t g = 0; g < games; ++g) {
+      wins += Game(seed + g, players).play().winner == swap_seats;
+    }
+    for (Player *p : players) delete p;
+  }
+  const double total = 2 * static_cast<double>(games);
+  cout << fixed << setprecision(1) << "Neural wins " << 100 * static_cast<double>(wins) / total
+       << "% of " << 2 * games << " games against Simple ("
+       << setprecision(0) << total / seconds_since(start) << " games/s)\n";
+
+  // The same hands played one decision at a time and in batches
+  Rng rng(seed);
+  vector<Hand_state> one = random_hands(rng, 4096), batched = one;
+  start = chrono::steady_clock::now();
+  double decisions = static_cast<double>(play_out_batched(mlp, one, 1));
+  double one_seconds = seconds_since(start);
+  start = chrono::steady_clock::now();
+  play_out_batched(mlp, batched, 64);
+  double batched_seconds = seconds_since(start);
+  size_t differ = 0;
+  for (size_t i = 0; i < one.size(); ++i) {
+    differ += one[i].tricks[0] != batched[i].tricks[0];
+  }
+  cout << "decisions (" << mlp_kernels() << "): "
+       << decisions / one_seconds << "/s one at a time, "
+       << decisions / batched_seconds << "/s in batches of 64" << endl;
+  if (differ) {
+    cout << differ << " hands differ" << endl;
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) usage_and_exit();
+  string command = argv[1];
+  uint64_t games = 1000, seed = 1;
+  for (int i = 3; i < argc; ++i) {
+    string arg = argv[i];
+    if (i + 1 == argc) usage_and_exit();
+    if (arg == "-n") {
+      games = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-s") {
+      seed = strtoull(argv[++i], nullptr, 10);
+    } else {
+      usage_and_exit();
+    }
+  }
+  if (command == "train") return train(argv[2], games, seed);
+  if (command == "bench") return bench(argv[2], games, seed);
+  usage_and_exit();
+}
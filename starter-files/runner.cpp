@@ -0,0 +1,218 @@
+// runner.cpp
+// Parallel batch runner: plays every game of a manifest on a pool of worker
+// threads.  Each manifest line is one job in euchre.exe's argument format
+// (blank lines and lines starting with '#' are skipped).  Job i writes its
+// transcript, or with --summary its one-line summary, to OUTDIR/job<i>.out,
+// and the summaries are printed in manifest order at the end, so the output
+// is the same whatever the number of workers.
+//
+// Every distinct pack file is parsed and every script mapped once, before
+// the workers start; the workers share them read-only.
+#include "Game.hpp"
+#include "Game_spec.hpp"
+#include "MappedFile.hpp"
+#include "Pack.hpp"
+#include "Player.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct Job {
+  Game_spec spec;
+  string error;             // why the job cannot run; empty if it can
+  const Pack *pack = nullptr;
+  // Written by the worker that plays the job
+  string summary;
+  int status = 0;
+  int hands = 0;
+};
+
+// Parsed packs and mapped scripts, shared read-only by every worker
+struct Shared_inputs {
+  map<string, Pack> packs;
+  map<string, unique_ptr<MappedFile>> scripts;
+};
+
+static vector<Job> read_manifest(istream &is, bool summary) {
+  vector<Job> jobs;
+  for (string line; getline(is, line);) {
+    istringstream words(line);
+    vector<string> args;
+    for (string word; words >> word;) args.push_back(word);
+    if (args.empty() || args[0][0] == '#') continue;
+
+    Job job;
+    job.spec.summary = summary;
+    if (!parse_game_spec(args, job.spec)) {
+      job.error = "Error: invalid game: " + line;
+    }
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+// Loads every pack and script the jobs need; marks jobs that cannot run
+static void load_inputs(vector<Job> &jobs, Shared_inputs &in) {
+  for (Job &job : jobs) {
+    if (!job.error.empty()) continue;
+    const string &filename = job.spec.pack_filename;
+    auto found = in.packs.find(filename);
+    if (found == in.packs.end()) {
+      ifstream ifs(filename);
+      if (ifs.is_open()) found = in.packs.emplace(filename, Pack(ifs)).first;
+    }
+    if (found == in.packs.end()) {
+      job.error = "Error opening " + filename;
+      continue;
+    }
+    job.pack = &found->second;
+
+    for (int i = 0; i < 4 && job.error.empty(); ++i) {
+      const string &name = job.spec.names[i];
+      if (job.spec.types[i] == "Human") {
+        job.error = "Error: Human players cannot read input in a batch";
+      } else if (job.spec.types[i] == "Scripted") {
+        unique_ptr<MappedFile> &file = in.scripts[name];
+        if (!file) file.reset(new MappedFile(name + ".script"));
+        if (!file->is_open()) job.error = "Error opening " + name + ".script";
+      }
+    }
+  }
+}
+
+static void run_job(Job &job, const Shared_inputs &in, const string &outdir,
+                    int index) {
+  ostringstream out;
+  if (job.error.empty()) {
+    Player *players[4];
+    for (int i = 0; i < 4; ++i) {
+      const string &name = job.spec.names[i];
+      if (job.spec.types[i] == "Scripted") {
+        const MappedFile &file = *in.scripts.at(name);
+        players[i] = Scripted_factory(name, file.data(), file.size());
+      } else {
+        players[i] = Player_factory(name, job.spec.types[i]);
+      }
+    }
+    Game_state state{*job.pack};
+    job.status = play_game_spec(job.spec, state, players, out);
+    job.hands = state.hand;
+    for (Player *p : players) delete p;
+
+    ostringstream summary;
+    if (job.spec.summary) {
+      summary << out.str();
+    } else if (job.status == 0) {
+      print_game_summary(summary, job.spec, state);
+    } else {
+      summary << "Error: illegal play, see job" << index + 1 << ".out\n";
+    }
+    job.summary = summary.str();
+  } else {
+    job.status = 1;
+    out << job.error << '\n';
+    job.summary = job.error + '\n';
+  }
+  const string path = outdir + "/job" + to_string(index + 1) + ".out";
+  ofstream file(path);
+  file << out.str();
+  file.close();
+  if (!file) {
+    job.status = 1;
+    job.summary = "Error writing " + path + '\n';
+  }
+}
+
+static void usage_and_exit() {
+  cout << "Usage: runner.exe [-j WORKERS] [--summary] MANIFEST OUTDIR" << endl;
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  unsigned workers = max(1u, thread::hardware_concurrency());
+  bool summary = false;
+  vector<string> paths;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "-j" && i + 1 < argc) {
+      workers = static_cast<unsigned>(atoi(argv[++i]));
+    } else if (arg == "--summary") {
+      summary = true;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  if (paths.size() != 2 || workers == 0) usage_and_exit();
+
+  ifstream manifest(paths[0]);
+  if (!manifest.is_open()) {
+    cout << "Error opening " << paths[0] << endl;
+    return 1;
+  }
+  const string &outdir = paths[1];
+  struct stat outdir_stat;
+  if ((mkdir(outdir.c_str(), 0777) != 0 && errno != EEXIST)
+      || stat(outdir.c_str(), &outdir_stat) != 0
+      || !S_ISDIR(outdir_stat.st_mode)) {
+    cout << "Error creating directory " << outdir << endl;
+    return 1;
+  }
+
+  vector<Job> jobs = read_manifest(manifest, summary);
+  Shared_inputs inputs;
+  load_inputs(jobs, inputs);
+
+  // Workers take the next job from a shared counter
+  atomic<size_t> next_job(0), jobs_done(0);
+  auto work = [&]() {
+    for (size_t i; (i = next_job++) < jobs.size(); ++jobs_done) {
+      run_job(jobs[i], inputs, outdir, static_cast<int>(i));
+    }
+  };
+  auto start = chrono::steady_clock::now();
+  vector<thread> pool;
+  for (unsigned w = 0; w < workers; ++w) pool.emplace_back(work);
+
+  // Progress on stderr about once a second while the workers run
+  auto seconds = [&]() {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+  };
+  double next_report = 1;
+  while (jobs_done < jobs.size()) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+    if (seconds() >= next_report) {
+      cerr << jobs_done << "/" << jobs.size() << " jobs, "
+           << jobs_done / seconds() << " jobs/s" << endl;
+      next_report += 1;
+    }
+  }
+  for (thread &t : pool) t.join();
+  double elapsed = seconds();
+
+  uint64_t hands = 0;
+  int status = 0;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    hands += static_cast<uint64_t>(jobs[i].hands);
+    status |= jobs[i].status;
+    cout << "job" << i + 1 << ": " << jobs[i].summary;
+  }
+  cerr << jobs.size() << " jobs, " << hands << " hands in " << elapsed
+       << " s with " << workers << " workers ("
+       << static_cast<double>(jobs.size()) / elapsed << " jobs/s, "
+       << static_cast<double>(hands) / elapsed << " hands/s)" << endl;
+  return status;
+}
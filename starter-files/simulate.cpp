@@ -0,0 +1,446 @@
+// simulate.cpp
+// Batch simulator: plays many games with uniformly random deals and prints
+// aggregate results.  Long runs can checkpoint periodically and resume
+// bit-exactly after being stopped or preempted.  With --stats it also
+// prints hardware counters per hand for each phase of play, and with
+// --breakdown the outcomes of hands by situation.  Runs without checkpoints
+// can be split across threads with -j; the results do not change.
+#include "Game.hpp"
+#include "Hand_stats.hpp"
+#include "Pack.hpp"
+#include "PerfCounters.hpp"
+#include "Player.hpp"
+#include "Rng.hpp"
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+struct Sim_options {
+  uint64_t num_games = 100000;
+  uint64_t seed = 1;
+  int points_to_win = 10;
+  string types[4] = {"Simple", "Simple", "Simple", "Simple"};
+  string checkpoint;          // empty: never checkpoint
+  double interval = 60;       // seconds between checkpoints
+  bool resume = false;
+  uint64_t stop_after = 0;    // hands to play in this run; 0: no limit
+  bool stats = false;         // print counters per phase
+  bool breakdown = false;     // print outcomes by situation
+  unsigned threads = 1;
+};
+
+// Results summed over finished games
+struct Sim_totals {
+  uint64_t games = 0;
+  uint64_t hands = 0;
+  uint64_t wins[2] = {0, 0};
+  uint64_t points[2] = {0, 0};
+  uint64_t marches[2] = {0, 0};
+  uint64_t euchres[2] = {0, 0};   // by the defending team
+  Hand_stats stats;
+};
+
+// Everything needed to continue a run exactly where it stopped.  Games are
+// only ever interrupted between hands, when every hand is empty.
+struct Sim_progress {
+  uint64_t game = 0;        // index of the game in progress
+  bool in_game = false;     // false: game has not started yet
+  Rng rng;                  // deals of the game in progress
+  Game_state state;
+  Sim_totals totals;
+};
+
+// Checkpoint files
+
+static const uint64_t CHECKPOINT_MAGIC = 0x32544b4345525545ULL; // "EUCREKT2"
+
+static void put(vector<unsigned char> &out, uint64_t x) {
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<unsigned char>(x >> (8 * i)));
+  }
+}
+
+static uint64_t get(const vector<unsigned char> &in, size_t &pos) {
+  uint64_t x = 0;
+  for (int i = 0; i < 8 && pos < in.size(); ++i) {
+    x |= static_cast<uint64_t>(in[pos++]) << (8 * i);
+  }
+  return x;
+}
+
+// A hash of the options that must not change between a run and its resume
+static uint64_t options_key(const Sim_options &opt) {
+  uint64_t key = opt.num_games * 31 + opt.seed;
+  key = key * 31 + static_cast<uint64_t>(opt.points_to_win);
+  for (const string &t : opt.types) {
+    for (char c : t) key = key * 31 + static_cast<unsigned char>(c);
+  }
+  return key;
+}
+
+static vector<unsigned char> encode(const Sim_options &opt,
+                                    const Sim_progress &p) {
+  vector<unsigned char> out;
+  put(out, CHECKPOINT_MAGIC);
+  put(out, options_key(opt));
+  put(out, p.game);
+  put(out, p.in_game);
+  put(out, p.rng.get_state());
+  put(out, static_cast<uint64_t>(p.state.hand));
+  put(out, static_cast<uint64_t>(p.state.dealer));
+  put(out, static_cast<uint64_t>(p.state.score[0]));
+  put(out, static_cast<uint64_t>(p.state.score[1]));
+  put(out, static_cast<uint64_t>(p.state.pack.get_next()));
+  for (const Card &c : p.state.pack.get_cards()) {
+    out.push_back(static_cast<unsigned char>(c.get_rank() * 4 + c.get_suit()));
+  }
+  const Sim_totals &t = p.totals;
+  const uint64_t fields[] = {t.games, t.hands, t.wins[0], t.wins[1],
+                             t.points[0], t.points[1], t.marches[0],
+                             t.marches[1], t.euchres[0], t.euchres[1]};
+  for (uint64_t f : fields) put(out, f);
+  for (int i = 0; i < Hand_stats::NUM_COUNTS; ++i) put(out, t.stats.data()[i]);
+  return out;
+}
+
+static bool decode(const vector<unsigned char> &in, const Sim_options &opt,
+                   Sim_progress &p) {
+  size_t pos = 0;
+  if (get(in, pos) != CHECKPOINT_MAGIC || get(in, pos) != options_key(opt)) {
+    return false;
+  }
+  p.game = get(in, pos);
+  p.in_game = get(in, pos) != 0;
+  p.rng.set_state(get(in, pos));
+  p.state.hand = static_cast<int>(get(in, pos));
+  p.state.dealer = static_cast<int>(get(in, pos));
+  p.state.score[0] = static_cast<int>(get(in, pos));
+  p.state.score[1] = static_cast<int>(get(in, pos));
+  int next = static_cast<int>(get(in, pos));
+  array<Card, Pack::PACK_SIZE> cards;
+  for (Card &c : cards) {
+    int code = pos < in.size() ? in[pos++] : 0;
+    c = Card(static_cast<Rank>(code / 4), static_cast<Suit>(code % 4));
+  }
+  p.state.pack = Pack(cards);
+  for (int i = 0; i < next; ++i) p.state.pack.deal_one();
+
+  Sim_totals &t = p.totals;
+  uint64_t *fields[] = {&t.games, &t.hands, &t.wins[0], &t.wins[1],
+                        &t.points[0], &t.points[1], &t.marches[0],
+                        &t.marches[1], &t.euchres[0], &t.euchres[1]};
+  for (uint64_t *f : fields) *f = get(in, pos);
+  for (int i = 0; i < Hand_stats::NUM_COUNTS; ++i) {
+    t.stats.data()[i] = get(in, pos);
+  }
+  return pos == in.size();
+}
+
+// Writes to a temporary file, syncs it to disk and renames it over the
+// checkpoint, so a crash mid-write leaves the previous checkpoint intact.
+static bool save_checkpoint(const Sim_options &opt, const Sim_progress &p) {
+  vector<unsigned char> bytes = encode(opt, p);
+  string tmp = opt.checkpoint + ".tmp";
+  {
+    ofstream out(tmp, ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char *>(bytes.data()),
+              static_cast<streamsize>(bytes.size()));
+    if (!out.flush()) return false;
+  }
+  // Otherwise the rename may reach the disk before the data does
+  int fd = open(tmp.c_str(), O_RDONLY);
+  bool synced = fd != -1 && fsync(fd) == 0;
+  if (fd != -1) close(fd);
+  return synced && rename(tmp.c_str(), opt.checkpoint.c_str()) == 0;
+}
+
+static bool load_checkpoint(const Sim_options &opt, Sim_progress &p) {
+  ifstream in(opt.checkpoint, ios::binary);
+  vector<unsigned char> bytes((istreambuf_iterator<char>(in)),
+                              istreambuf_iterator<char>());
+  return in.is_open() && decode(bytes, opt, p);
+}
+
+// Simulation
+
+// Set by SIGINT/SIGTERM: finish the current hand, checkpoint and exit.
+static volatile sig_atomic_t stop_requested = 0;
+
+static void request_stop(int) { stop_requested = 1; }
+
+// Splits the counters among the phases of each hand: the deal (with the
+// shuffle policy), bidding, and playing and scoring the tricks.  Reading the
+// counters is a system call, so it is three per hand and only with --stats.
+class Phase_stats : public Game_observer {
+public:
+  void hand_begin(int hand, int dealer) override { last = counters.read(); }
+  void upcard(const Card &upcard) override { lap(DEAL); }
+  void bidding_end() override { lap(BIDDING); }
+  void hand_end(const Hand_result &result, const Game_state &state) override {
+    lap(PLAY);
+    ++hands;
+  }
+
+  void print(ostream &os) const {
+    static const char *const NAMES[] = {"deal:    ", "bidding: ", "play:    "};
+    for (int phase = 0; phase < NUM_PHASES; ++phase) {
+      os << "per hand, " << NAMES[phase];
+      counters.print(os, phases[phase], static_cast<double>(hands));
+      os << '\n';
+    }
+  }
+
+private:
+  enum Phase { DEAL, BIDDING, PLAY, NUM_PHASES };
+
+  void lap(Phase phase) {
+    PerfSample now = counters.read();
+    phases[phase] += now - last;
+    last = now;
+  }
+
+  PerfCounters counters;
+  PerfSample last;
+  PerfSample phases[NUM_PHASES];
+  uint64_t hands = 0;
+};
+
+static void add_hand(Sim_totals &t, const Hand_result &hr) {
+  ++t.hands;
+  int makers = hr.maker % 2;
+  if (hr.march) ++t.marches[makers];
+  if (hr.euchred) ++t.euchres[1 - makers];
+  t.stats.add(hr);
+}
+
+static void add_game(Sim_totals &t, const Game_state &state, int winner) {
+  ++t.games;
+  ++t.wins[winner];
+  t.points[0] += static_cast<uint64_t>(state.score[0]);
+  t.points[1] += static_cast<uint64_t>(state.score[1]);
+}
+
+static void add_totals(Sim_totals &t, const Sim_totals &u) {
+  t.games += u.games;
+  t.hands += u.hands;
+  for (int team = 0; team < 2; ++team) {
+    t.wins[team] += u.wins[team];
+    t.points[team] += u.points[team];
+    t.marches[team] += u.marches[team];
+    t.euchres[team] += u.euchres[team];
+  }
+  t.stats.merge(u.stats);
+}
+
+static void make_players(const Sim_options &opt, Player *players[]) {
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  for (int i = 0; i < 4; ++i) players[i] = Player_factory(NAMES[i], opt.types[i]);
+}
+
+// Plays games shard, shard + threads, shard + 2 * threads, ... with players
+// of its own.  Every game draws its own deals, so the sum of the shards'
+// totals is the same as playing the games in order.
+static void run_shard(const Sim_options &opt, unsigned shard, Sim_totals &t) {
+  Player *players[4];
+  make_players(opt, players);
+  Game_config config;
+  config.points_to_win = opt.points_to_win;
+  Game_observer quiet;
+  for (uint64_t game = shard; game < opt.num_games; game += opt.threads) {
+    Rng rng(game_seed(opt.seed, game));
+    Game_state state;
+    while (!game_over(state, config)) {
+      state.pack.shuffle(rng);
+      add_hand(t, play_hand(state, players, config, quiet));
+    }
+    add_game(t, state, state.score[0] >= opt.points_to_win ? 0 : 1);
+  }
+  for (Player *p : players) delete p;
+}
+
+// Plays all games on opt.threads threads, each adding to its own totals,
+// and merges them when every thread is done.
+static void run_parallel(const Sim_options &opt, Sim_progress &p) {
+  vector<Sim_totals> shards(opt.threads);
+  vector<thread> pool;
+  for (unsigned i = 0; i < opt.threads; ++i) {
+    pool.emplace_back(run_shard, cref(opt), i, ref(shards[i]));
+  }
+  for (thread &t : pool) t.join();
+  for (const Sim_totals &t : shards) add_totals(p.totals, t);
+  p.game = opt.num_games;
+}
+
+// Plays games until all are done, the hand budget for this run is spent or
+// a stop is requested.  Returns true if all games are done.
+static bool run(const Sim_options &opt, Player *const players[],
+                Sim_progress &p, Game_observer &obs) {
+  Game_config config;
+  config.points_to_win = opt.points_to_win;
+  using clock = chrono::steady_clock;
+  auto next_checkpoint = clock::now() + chrono::duration<double>(opt.interval);
+  uint64_t hands_this_run = 0;
+
+  for (; p.game < opt.num_games; ++p.game, p.in_game = false) {
+    if (!p.in_game) {
+      p.rng = Rng(game_seed(opt.seed, p.game));
+      p.state = Game_state();
+      p.in_game = true;
+    }
+    while (!game_over(p.state, config)) {
+      if (stop_requested ||
+          (opt.stop_after && hands_this_run == opt.stop_after)) {
+        return false;
+      }
+      // Reading the clock once per 64 hands keeps its cost out of sight.
+      if (!opt.checkpoint.empty() && (p.totals.hands & 63) == 0 &&
+          clock::now() >= next_checkpoint) {
+        save_checkpoint(opt, p);
+        next_checkpoint = clock::now() +
+                          chrono::duration<double>(opt.interval);
+      }
+      p.state.pack.shuffle(p.rng);
+      add_hand(p.totals, play_hand(p.state, players, config, obs));
+      ++hands_this_run;
+    }
+    add_game(p.totals, p.state, p.state.score[0] >= opt.points_to_win ? 0 : 1);
+  }
+  return true;
+}
+
+static void print_totals(const Sim_totals &t, Player *const players[]) {
+  cout << fixed << setprecision(4);
+  cout << "games " << t.games << ", hands " << t.hands << '\n';
+  for (int team = 0; team < 2; ++team) {
+    double games = t.games ? static_cast<double>(t.games) : 1;
+    double hands = t.hands ? static_cast<double>(t.hands) : 1;
+    cout << *players[team] << " and " << *players[team + 2] << ": "
+         << "win rate " << t.wins[team] / games
+         << ", points/game " << t.points[team] / games
+         << ", marches/hand " << t.marches[team] / hands
+         << ", euchres/hand " << t.euchres[team] / hands << '\n';
+  }
+}
+
+static void usage_and_exit() {
+  cout << "Usage: simulate.exe [-n GAMES] [-s SEED] [-p POINTS_TO_WIN]\n"
+       << "         [--players TYPE1 TYPE2 TYPE3 TYPE4] (Simple or Neural)\n"
+       << "         [--checkpoint FILE [--interval SECONDS] [--resume]]\n"
+       << "         [--stop-after HANDS] [--stats] [--breakdown]\n"
+       << "         [-j THREADS]" << endl;
+  exit(1);
+}
+
+static Sim_options parse_options(int argc, char *argv[]) {
+  Sim_options opt;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    int needed = arg == "--players" ? 4 : 1;
+    if (arg == "--resume" || arg == "--stats" || arg == "--breakdown") {
+      needed = 0;
+    }
+    if (i + needed >= argc) usage_and_exit();
+    if (arg == "-n") {
+      opt.num_games = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-s") {
+      opt.seed = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-p") {
+      opt.points_to_win = atoi(argv[++i]);
+    } else if (arg == "--players") {
+      for (string &t : opt.types) t = argv[++i];
+    } else if (arg == "--checkpoint") {
+      opt.checkpoint = argv[++i];
+    } else if (arg == "--interval") {
+      opt.interval = atof(argv[++i]);
+    } else if (arg == "--resume") {
+      opt.resume = true;
+    } else if (arg == "--stats") {
+      opt.stats = true;
+    } else if (arg == "--breakdown") {
+      opt.breakdown = true;
+    } else if (arg == "-j") {
+      opt.threads = static_cast<unsigned>(atoi(argv[++i]));
+    } else if (arg == "--stop-after") {
+      opt.stop_after = strtoull(argv[++i], nullptr, 10);
+    } else {
+      usage_and_exit();
+    }
+  }
+  if (opt.points_to_win < 1 || (opt.resume && opt.checkpoint.empty())) {
+    usage_and_exit();
+  }
+  // Checkpoints, hand budgets and counters follow a single thread
+  if (opt.threads < 1 || (opt.threads > 1 && (!opt.checkpoint.empty() ||
+                                              opt.stop_after || opt.stats))) {
+    usage_and_exit();
+  }
+  return opt;
+}
+
+int main(int argc, char *argv[]) {
+  Sim_options opt = parse_options(argc, argv);
+  // Humans need input, and Scripted players would replay their scripts
+  // from the start in every thread and after every resume
+  for (const string &type : opt.types) {
+    if (type != "Simple" && type != "Neural") usage_and_exit();
+  }
+  Player *players[4];
+  make_players(opt, players);
+
+  Sim_progress progress;
+  if (opt.resume && !load_checkpoint(opt, progress)) {
+    cout << "Error: cannot resume from " << opt.checkpoint
+         << " with these options" << endl;
+    return 1;
+  }
+  signal(SIGINT, request_stop);
+  signal(SIGTERM, request_stop);
+
+  auto start = chrono::steady_clock::now();
+  uint64_t hands_before = progress.totals.hands;
+  Game_observer quiet;
+  Phase_stats stats;
+  bool done = true;
+  if (opt.threads > 1) {
+    run_parallel(opt, progress);
+  } else {
+    done = run(opt, players, progress,
+               opt.stats ? static_cast<Game_observer &>(stats) : quiet);
+  }
+  double seconds = chrono::duration<double>(
+    chrono::steady_clock::now() - start).count();
+  cerr << progress.totals.hands - hands_before << " hands in " << seconds
+       << " s" << endl;
+
+  int status = 0;
+  if (!done) {
+    if (opt.checkpoint.empty() || !save_checkpoint(opt, progress)) {
+      cout << "Stopped without a checkpoint" << endl;
+      status = 1;
+    } else {
+      cout << "Stopped at game " << progress.game << "; checkpoint in "
+           << opt.checkpoint << endl;
+      status = 2;
+    }
+  } else {
+    print_totals(progress.totals, players);
+    if (opt.breakdown) progress.totals.stats.print(cout);
+    if (opt.stats) stats.print(cout);
+    if (!opt.checkpoint.empty()) remove(opt.checkpoint.c_str());
+  }
+  for (Player *p : players) delete p;
+  return status;
+}
@@ -0,0 +1,207 @@
+// tune.cpp
+// Searches the parameters of the "Simple" strategy (see Simple_params) for
+// the set that beats the default Simple most often:
+//
+//   ./tune.exe [-n GAMES] [-v GAMES] [-s SEED] [-j THREADS]
+//
+// Every candidate plays a team of default Simple players by successive
+// halving: all candidates play -n deals, the better half plays twice as
+// many, and so on until one is left.  Each deal is played twice with the
+// teams' seats swapped, and every candidate plays the same deals, so the
+// luck of the cards cancels out of every comparison.  The winner is then
+// measured on -v fresh deals.  Candidates are spread across threads; the
+// result does not depend on how many.
+#include "Euchre.hpp"
+#include "Player.hpp"
+#include "Rng.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct Tune_options {
+  uint64_t deals = 100;         // deals per candidate in the first round
+  uint64_t verify_deals = 20000;
+  uint64_t seed = 1;
+  unsigned threads = thread::hardware_concurrency();
+};
+
+// The values searched for each parameter, all combinations of which are
+// candidates
+struct Dimension {
+  const char *name;
+  int low, high;
+};
+
+static const Dimension DIMENSIONS[] = {
+  {"order_up_round1", 1, 4},
+  {"order_up_round2", 0, 3},
+  {"name_any_suit", 0, 1},
+  {"lead_trump_from", 2, 6},
+  {"follow_low", 0, 1},
+};
+static const int NUM_DIMENSIONS = sizeof(DIMENSIONS) / sizeof(DIMENSIONS[0]);
+
+struct Candidate {
+  int values[NUM_DIMENSIONS];
+  uint64_t deals = 0;   // deals played, each twice
+  uint64_t wins = 0;    // games won of 2 * deals
+};
+
+static Simple_params to_params(const int values[]) {
+  Simple_params p;
+  p.order_up_round1 = values[0];
+  p.order_up_round2 = values[1];
+  p.name_any_suit = values[2];
+  p.lead_trump_from = values[3];
+  p.follow_low = values[4];
+  return p;
+}
+
+static vector<Candidate> all_candidates() {
+  vector<Candidate> all(1);
+  for (int d = 0; d < NUM_DIMENSIONS; ++d) {
+    vector<Candidate> more;
+    for (const Candidate &c : all) {
+      for (int v = DIMENSIONS[d].low; v <= DIMENSIONS[d].high; ++v) {
+        more.push_back(c);
+        more.back().values[d] = v;
+      }
+    }
+    all.swap(more);
+  }
+  return all;
+}
+
+static void print_params(const int values[]) {
+  for (int d = 0; d < NUM_DIMENSIONS; ++d) {
+    cout << (d ? " " : "") << DIMENSIONS[d].name << "=" << values[d];
+  }
+}
+
+// Plays deals [from, to) of seed twice each, the candidate's team in seats
+// 0 and 2 and then in 1 and 3, and returns the games it won
+static uint64_t play_deals(const Simple_params &params, uint64_t seed,
+                           uint64_t from, uint64_t to) {
+  static const char *const NAMES[] = {"North", "East", "South", "West"};
+  uint64_t wins = 0;
+  for (int team = 0; team < 2; ++team) {
+    Player *players[4];
+    for (int i = 0; i < 4; ++i) {
+      players[i] = i % 2 == team ? Simple_factory(NAMES[i], params)
+                                 : Player_factory(NAMES[i], "Simple");
+    }
+    for (uint64_t deal = from; deal < to; ++deal) {
+      wins += Game(game_seed(seed, deal), players).play().winner == team;
+    }
+    for (Player *p : players) delete p;
+  }
+  return wins;
+}
+
+// Brings every candidate up to deals deals, threads taking candidates in
+// turn
+static void play_up_to(vector<Candidate> &candidates, uint64_t deals,
+                       const Tune_options &opt) {
+  atomic<size_t> next(0);
+  auto work = [&]() {
+    for (size_t i = next++; i < candidates.size(); i = next++) {
+      Candidate &c = candidates[i];
+      c.wins += play_deals(to_params(c.values), opt.seed, c.deals, deals);
+      c.deals = deals;
+    }
+  };
+  vector<thread> pool;
+  for (unsigned i = 1; i < opt.threads; ++i) pool.emplace_back(work);
+  work();
+  for (thread &t : pool) t.join();
+}
+
+static void usage_and_exit() {
+  cout << "Usage: tune.exe [-n GAMES] [-v GAMES] [-s SEED] [-j THREADS]"
+       << endl;
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  Tune_options opt;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (i + 1 == argc) usage_and_exit();
+    if (arg == "-n") {
+      opt.deals = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-v") {
+      opt.verify_deals = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-s") {
+      opt.seed = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-j") {
+      opt.threads = static_cast<unsigned>(atoi(argv[++i]));
+    } else {
+      usage_and_exit();
+    }
+  }
+  if (opt.deals < 1 || opt.verify_deals < 1) usage_and_exit();
+  opt.threads = max(opt.threads, 1u);
+
+  auto start = chrono::steady_clock::now();
+  vector<Candidate> candidates = all_candidates();
+  uint64_t deals = opt.deals;
+  while (true) {
+    play_up_to(candidates, deals, opt);
+    // Equal scores keep the order of the grid, so ties break the same way
+    // on any number of threads
+    stable_sort(candidates.begin(), candidates.end(),
+                [](const Candidate &a, const Candidate &b) {
+                  return a.wins > b.wins;
+                });
+    cout << candidates.size() << " candidates after " << deals
+         << " deals, best wins " << fixed << setprecision(1)
+         << 50.0 * static_cast<double>(candidates[0].wins)
+            / static_cast<double>(deals) << "%" << endl;
+    if (candidates.size() == 1) break;
+    candidates.resize((candidates.size() + 1) / 2);
+    deals *= 2;
+  }
+
+  // The winner on deals none of the rounds played
+  const Candidate &best = candidates[0];
+  const uint64_t verify_seed = opt.seed + 1;
+  vector<uint64_t> wins(opt.threads);
+  vector<thread> pool;
+  for (unsigned i = 0; i < opt.threads; ++i) {
+    pool.emplace_back([&, i]() {
+      wins[i] = play_deals(to_params(best.values), verify_seed,
+                           opt.verify_deals * i / opt.threads,
+                           opt.verify_deals * (i + 1) / opt.threads);
+    });
+  }
+  for (thread &t : pool) t.join();
+  const double games = 2 * static_cast<double>(opt.verify_deals);
+  double rate = 0;
+  for (uint64_t w : wins) rate += static_cast<double>(w) / games;
+  const double error = sqrt(rate * (1 - rate) / games);
+
+  cout << "best: ";
+  print_params(best.values);
+  const Simple_params d;
+  const int default_values[] = {d.order_up_round1, d.order_up_round2,
+                                d.name_any_suit, d.lead_trump_from,
+                                d.follow_low};
+  cout << "\ndefault: ";
+  print_params(default_values);
+  cout << "\nedge over default: " << showpos << 100 * (rate - 0.5)
+       << noshowpos << "% +- " << 100 * error << "% of "
+       << 2 * opt.verify_deals << " games" << endl;
+  cerr << setprecision(2) << chrono::duration<double>(
+            chrono::steady_clock::now() - start).count() << " s" << endl;
+  return 0;
+}
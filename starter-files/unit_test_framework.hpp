@@ -51,6 +51,10 @@
 #include <algorithm>
 #include <exception>
 #include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iomanip>
 #if UNIT_TEST_ENABLE_REGEXP
 #  include <regex>
 #endif
@@ -76,6 +80,27 @@
     register_##name((#name), name);                     \
   static void name()
 
+// A benchmark, run only when the test program is given --bench.  The body
+// does its work bench.iterations times, passing results it would otherwise
+// discard to do_not_optimize():
+//
+//   BENCH(bench_card_less) {
+//     for (long i = 0; i < bench.iterations; ++i) {
+//       unit_test_framework::do_not_optimize(Card_less(a, b, trump));
+//     }
+//   }
+//
+// The iteration count is calibrated until one run takes long enough to
+// time; after a warm-up run, the median and the median absolute deviation
+// of the time per iteration over several runs are reported.  The numbers
+// are only as meaningful as the optimization the test program is built
+// with.
+#define BENCH(name)                                     \
+  static void name(unit_test_framework::Bench&);        \
+  static unit_test_framework::BenchRegisterer           \
+    register_##name((#name), name);                     \
+  static void name(unit_test_framework::Bench& bench)
+
 #define TEST_MAIN()                                                     \
   int main(int argc, char** argv) {                                     \
     return                                                              \
@@ -124,6 +149,34 @@ namespace unit_test_framework {
 
   using Test_func_t = void (*)();
 
+  // What a BENCH body is told: how many times to do its work
+  struct Bench {
+    long iterations = 1;
+  };
+
+  using Bench_func_t = void (*)(Bench&);
+
+  // Keeps the compiler from discarding value, or the work that made it
+  template <class T>
+  inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+  }
+
+  // Makes the compiler assume all memory is read and written here, so
+  // stores made in the loop are not discarded either
+  inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+  }
+
   class ExitSuite : public std::exception {
   public:
     ExitSuite(int status_ = 0) : status(status_) {}
@@ -292,6 +345,13 @@ namespace unit_test_framework {
       : name(name_), test_func(test_func_) {}
 
     void run(bool quiet_mode) {
+      auto start = std::chrono::steady_clock::now();
+      run_timed(quiet_mode);
+      seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    }
+
+    void run_timed(bool quiet_mode) {
       try {
         if (not quiet_mode) {
           std::cout << "Running test: " << name << std::endl;
@@ -352,6 +412,85 @@ namespace unit_test_framework {
     Test_func_t test_func;
     std::string failure_msg{};
     std::string exception_msg{};
+    double seconds = 0;  // wall time of the last run
+  };
+
+  // ---------------------------------------------------------------------------
+
+  struct BenchCase {
+    static constexpr double MIN_RUN_SECONDS = 0.01;
+    static constexpr int RUNS = 11;
+    static constexpr long MAX_ITERATIONS = 1L << 40;
+
+    BenchCase(const std::string& name_, Bench_func_t bench_func_)
+      : name(name_), bench_func(bench_func_) {}
+
+    // Calibrates, warms up and times the benchmark.  Returns false if it
+    // failed an assertion or threw, leaving the reason in failure_msg.
+    bool run() {
+      try {
+        Bench bench;
+        while (time(bench) < MIN_RUN_SECONDS and
+               bench.iterations < MAX_ITERATIONS) {
+          bench.iterations *= 2;
+        }
+        time(bench);  // warm-up
+        std::vector<double> per_iteration;
+        for (int i = 0; i < RUNS; ++i) {
+          per_iteration.push_back(time(bench) / bench.iterations);
+        }
+        iterations = bench.iterations;
+        median_seconds = median(per_iteration);
+        for (double& t : per_iteration) {
+          t = std::abs(t - median_seconds);
+        }
+        mad_seconds = median(per_iteration);
+        return true;
+      }
+      catch (TestFailure& failure) {
+        failure_msg = failure.to_string();
+      }
+      catch (std::exception& e) {
+        failure_msg = std::string("Uncaught ")
+          + Diagnostic::demangle(typeid(e).name()) + ": " + e.what() + "\n";
+      }
+      return false;
+    }
+
+    void print(std::size_t name_width) const {
+      std::cout << std::left << std::setw(static_cast<int>(name_width))
+                << name << std::right;
+      if (not failure_msg.empty()) {
+        std::cout << "  FAIL\n" << failure_msg << std::endl;
+        return;
+      }
+      std::cout << std::fixed << std::setprecision(2)
+                << std::setw(12) << median_seconds * 1e9 << " ns"
+                << "  +- " << std::setw(8) << mad_seconds * 1e9 << " ns"
+                << "  (" << RUNS << " x " << iterations << ")"
+                << std::defaultfloat << std::endl;
+    }
+
+    std::string name;
+    Bench_func_t bench_func;
+    std::string failure_msg{};
+    long iterations = 0;
+    double median_seconds = 0;   // per iteration
+    double mad_seconds = 0;      // median absolute deviation from it
+
+  private:
+    double time(Bench& bench) {
+      auto start = std::chrono::steady_clock::now();
+      bench_func(bench);
+      return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    }
+
+    static double median(std::vector<double> values) {
+      auto middle = values.begin() + values.size() / 2;
+      std::nth_element(values.begin(), middle, values.end());
+      return *middle;
+    }
   };
 
 
@@ -368,6 +507,10 @@ namespace unit_test_framework {
       tests_.insert({test_name, TestCase{test_name, test}});
     }
 
+    void add_bench(const std::string& bench_name, Bench_func_t bench) {
+      benches_.insert({bench_name, BenchCase{bench_name, bench}});
+    }
+
     int run_tests(int argc, char** argv) {
       SetComplete completer(TestSuite::incomplete);
       std::vector<std::string> test_names_to_run;
@@ -378,14 +521,23 @@ namespace unit_test_framework {
         return e.status;
       }
 
+      if (bench_mode) {
+        return run_benches(test_names_to_run);
+      }
+
       for (auto test_name : test_names_to_run) {
         if (tests_.find(test_name) == end(tests_)) {
           throw std::runtime_error("Test " + test_name + " not found");
         }
       }
 
-      for (auto test_name : test_names_to_run) {
-        tests_.at(test_name).run(quiet_mode);
+      if (num_jobs > 1) {
+        run_parallel(test_names_to_run);
+      }
+      else {
+        for (const auto& test_name : test_names_to_run) {
+          tests_.at(test_name).run(quiet_mode);
+        }
       }
 
       std::cout << "\n*** Results ***" << std::endl;
@@ -395,12 +547,14 @@ namespace unit_test_framework {
 
       auto num_failures =
         std::count_if(tests_.begin(), tests_.end(),
-                      [](std::pair<std::string, TestCase> test_pair) {
+                      [](const std::pair<const std::string, TestCase>&
+                           test_pair) {
                         return not test_pair.second.failure_msg.empty();
                       });
       auto num_errors =
         std::count_if(tests_.begin(), tests_.end(),
-                      [](std::pair<std::string, TestCase> test_pair) {
+                      [](const std::pair<const std::string, TestCase>&
+                           test_pair) {
                         return not test_pair.second.exception_msg.empty();
                       });
 
@@ -410,6 +564,9 @@ namespace unit_test_framework {
                   << " tests run:" << std::endl;
         std::cout << num_failures << " failure(s), " << num_errors
                   << " error(s)" << std::endl;
+        if (num_jobs > 1) {
+          print_slowest(test_names_to_run);
+        }
       }
 
       if (num_failures == 0 and num_errors == 0) {
@@ -434,6 +591,87 @@ namespace unit_test_framework {
     friend class TestSuiteDestroyer;
 
   private:
+    // Runs the named benchmarks one at a time, so they do not disturb each
+    // other's timings, and returns 1 if any failed
+    int run_benches(const std::vector<std::string>& bench_names) {
+      for (const auto& bench_name : bench_names) {
+        if (benches_.find(bench_name) == end(benches_)) {
+          throw std::runtime_error("Benchmark " + bench_name + " not found");
+        }
+      }
+      std::size_t name_width = 0;
+      for (const auto& bench_name : bench_names) {
+        name_width = std::max(name_width, bench_name.size());
+      }
+      std::cout << "*** Benchmarks (time per iteration: median +- MAD) ***"
+                << std::endl;
+      int failures = 0;
+      for (const auto& bench_name : bench_names) {
+        BenchCase& bench = benches_.at(bench_name);
+        failures += not bench.run();
+        bench.print(name_width);
+      }
+      return failures == 0 ? 0 : 1;
+    }
+
+    // Names of every registered test, or benchmark under --bench
+    std::vector<std::string> registered_names() const {
+      std::vector<std::string> names;
+      if (bench_mode) {
+        for (const auto& bench_pair : benches_) {
+          names.push_back(bench_pair.first);
+        }
+      }
+      else {
+        for (const auto& test_pair : tests_) {
+          names.push_back(test_pair.first);
+        }
+      }
+      return names;
+    }
+
+    // Runs the named tests on num_jobs threads.  Each worker claims the next
+    // unclaimed test, so one slow test does not hold up a whole share.
+    // Progress lines are suppressed because they would interleave; results
+    // are still printed afterwards in name order.
+    void run_parallel(const std::vector<std::string>& test_names_to_run) {
+      std::vector<TestCase*> cases;
+      for (const auto& test_name : test_names_to_run) {
+        cases.push_back(&tests_.at(test_name));
+      }
+      std::atomic<std::size_t> next{0};
+      auto worker = [&cases, &next]() {
+        for (std::size_t i = next++; i < cases.size(); i = next++) {
+          cases[i]->run(true);
+        }
+      };
+      std::vector<std::thread> pool;
+      for (int i = 1; i < num_jobs; ++i) {
+        pool.emplace_back(worker);
+      }
+      worker();
+      for (auto& thread : pool) {
+        thread.join();
+      }
+    }
+
+    void print_slowest(const std::vector<std::string>& test_names_to_run) {
+      std::vector<const TestCase*> cases;
+      for (const auto& test_name : test_names_to_run) {
+        cases.push_back(&tests_.at(test_name));
+      }
+      std::size_t shown = std::min<std::size_t>(cases.size(), 5);
+      std::partial_sort(cases.begin(), cases.begin() + shown, cases.end(),
+                        [](const TestCase* a, const TestCase* b) {
+                          return a->seconds > b->seconds;
+                        });
+      std::cout << "*** Slowest tests ***" << std::endl;
+      for (std::size_t i = 0; i < shown; ++i) {
+        std::cout << cases[i]->seconds * 1000 << " ms\t" << cases[i]->name
+                  << std::endl;
+      }
+    }
+
     TestSuite() {
       auto func = []() {
         if (TestSuite::incomplete) {
@@ -467,6 +705,18 @@ namespace unit_test_framework {
                  argv[i] == std::string("-q")) {
           TestSuite::get().enable_quiet_mode();
         }
+        else if (argv[i] == std::string("--jobs") or
+                 argv[i] == std::string("-j")) {
+          if (i + 1 == argc) {
+            std::cout << "-j requires a number of jobs" << std::endl;
+            throw ExitSuite(1);
+          }
+          num_jobs = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argv[i] == std::string("--bench") or
+                 argv[i] == std::string("-b")) {
+          bench_mode = true;
+        }
 #if UNIT_TEST_ENABLE_REGEXP
         else if (argv[i] == std::string("--regexp") or
                  argv[i] == std::string("-e")) {
@@ -477,9 +727,9 @@ namespace unit_test_framework {
                  argv[i] == std::string("-h")) {
           std::cout << "usage: " << argv[0]
 #if UNIT_TEST_ENABLE_REGEXP
-                    << " [-h] [-e] [-n] [-q] [[TEST_NAME] ...]\n";
+                    << " [-h] [-e] [-n] [-q] [-j N] [-b] [[TEST_NAME] ...]\n";
 #else
-          << " [-h] [-n] [-q] [[TEST_NAME] ...]\n";
+          << " [-h] [-n] [-q] [-j N] [-b] [[TEST_NAME] ...]\n";
 #endif
           std::cout
             << "optional arguments:\n"
@@ -490,6 +740,10 @@ namespace unit_test_framework {
             << " -n, --show_test_names\t print the names of all "
             "discovered test cases and exit\n"
             << " -q, --quiet\t\t print a reduced summary of test results\n"
+            << " -j, --jobs N\t\t run tests on N threads and report the "
+            "slowest tests\n"
+            << " -b, --bench\t\t run the benchmarks instead of the tests; "
+            "TEST_NAME then names benchmarks\n"
             << " TEST_NAME ...\t\t run only the test cases whose names "
             "are "
             "listed here. Note: If no test names are specified, all "
@@ -504,12 +758,7 @@ namespace unit_test_framework {
       }
 
       if (test_names_to_run.empty()) {
-        std::transform(
-                       std::begin(tests_), std::end(tests_),
-                       std::back_inserter(test_names_to_run),
-                       [](const std::pair<std::string, TestCase>& p) {
-                         return p.first;
-                       });
+        test_names_to_run = registered_names();
       }
 #if UNIT_TEST_ENABLE_REGEXP
       else if (regexp_matching) {
@@ -523,9 +772,9 @@ namespace unit_test_framework {
         }
         std::regex name_regex{pattern.str()};
         test_names_to_run.clear();
-        for (const auto& test_pair : tests_) {
-          if (std::regex_match(test_pair.first, name_regex)) {
-            test_names_to_run.push_back(test_pair.first);
+        for (const auto& registered_name : registered_names()) {
+          if (std::regex_match(registered_name, name_regex)) {
+            test_names_to_run.push_back(registered_name);
           }
         }
       }
@@ -535,8 +784,11 @@ namespace unit_test_framework {
 
     static TestSuite* instance;
     std::map<std::string, TestCase> tests_;
+    std::map<std::string, BenchCase> benches_;
 
     bool quiet_mode = false;
+    bool bench_mode = false;
+    int num_jobs = 1;
     static bool incomplete;
   };
 
@@ -554,6 +806,13 @@ namespace unit_test_framework {
     }
   };
 
+  class BenchRegisterer {
+  public:
+    BenchRegisterer(const std::string& bench_name, Bench_func_t bench) {
+      TestSuite::get().add_bench(bench_name, bench);
+    }
+  };
+
   // ---------------------------------------------------------------------------
 
   class Assertions {